@@ -0,0 +1,940 @@
+#include "benchmark.h"
+#include "parser.h"
+#include "executor.h"
+#include "jit.h"
+#include "pushparser.h"
+#include "lexer.h"
+#include "parallel.h"
+#include "optimizer.h"
+#include "incremental.h"
+#include <chrono>
+#include <random>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <array>
+
+// 计时辅助: 返回执行 f 所用的秒数
+template <typename F>
+static double timeIt(F f)
+{
+    auto t0 = chrono::steady_clock::now();
+    f();
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double>(t1 - t0).count();
+}
+
+void benchmarkNative(GrammarAnalyzer& G)
+{
+    const string kernel = "while ( i < n ) { i = i + 1 }";
+    const long long iterations = 100000000;
+
+    cout << "基准测试: " << kernel << "  (n = " << iterations << ")" << endl;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        Parser parser(G);
+        parser.verbose = false;
+        parser.backpatch = (mode == 1);
+        if (!parser.parse(kernel)) return;
+
+        LoweredProgram prog;
+        string err;
+        if (!lowerQuads(parser.result, prog, err))
+        {
+            cout << "翻译失败: " << err << endl;
+            return;
+        }
+
+        int iSlot = prog.slotOf("i"), nSlot = prog.slotOf("n");
+        vector<long long> env1(prog.slotNames.size(), 0), env2;
+        env1[nSlot] = iterations;
+        env2 = env1;
+
+        cout << (mode == 0 ? "[普通模式]" : "[回填模式]") << " 四元式 " << parser.result.size() << " 条" << endl;
+
+        long long executed = 0;
+        Interpreter interp(prog);
+        double tInterp = timeIt([&]() { executed = interp.run(env1); });
+        cout << "  解释执行: " << tInterp << " s, 执行指令 " << executed
+             << " 条, i = " << env1[iSlot] << endl;
+
+        if (!NativeCode::supported())
+        {
+            cout << "  本地代码: 当前平台不支持" << endl;
+            continue;
+        }
+        NativeCode native;
+        double tCompile = timeIt([&]() {
+            if (!native.compile(prog, err)) cout << "  本地代码生成失败: " << err << endl;
+        });
+        if (!err.empty()) continue;
+        double tNative = timeIt([&]() { native.run(env2); });
+        cout << "  本地代码: " << tNative << " s (生成 " << tCompile * 1e6 << " us), i = " << env2[iSlot]
+             << (env1 == env2 ? "，结果一致" : "，结果不一致!") << endl;
+        cout << "  加速比: " << tInterp / tNative << "x" << endl;
+    }
+}
+
+// 随机表达式: a + 3 + b ...
+static string randomExpr(mt19937& rng)
+{
+    static const char* ids[] = {"a", "b", "c", "i", "j", "k", "n", "x", "y", "sum"};
+    int terms = 1 + rng() % 5;
+    string e;
+    for (int t = 0; t < terms; ++t)
+    {
+        if (t > 0) e += " + ";
+        if (rng() % 3 == 0) e += to_string(rng() % 100);
+        else e += ids[rng() % 10];
+    }
+    return e;
+}
+
+// 随机语句: 最多 depth 层嵌套的 while 循环
+static string randomStmt(mt19937& rng, int depth)
+{
+    static const char* relops[] = {">", "<", "=="};
+    static const char* ids[] = {"a", "b", "c", "i", "j", "k", "n", "x", "y", "sum"};
+    if (depth == 0 || rng() % 4 == 0)
+        return string(ids[rng() % 10]) + " = " + randomExpr(rng);
+    return "while ( " + randomExpr(rng) + " " + relops[rng() % 3] + " " + randomExpr(rng) +
+           " ) { " + randomStmt(rng, depth - 1) + " }";
+}
+
+vector<string> generateCorpus(int count, unsigned seed)
+{
+    mt19937 rng(seed);
+    vector<string> corpus;
+    for (int i = 0; i < count; ++i)
+        corpus.push_back(randomStmt(rng, 1 + rng() % 8));
+    return corpus;
+}
+
+void benchmarkUnitElimination(const string& grammarFile)
+{
+    vector<string> corpus = generateCorpus(2000);
+    size_t bytes = 0;
+    for (const auto& src : corpus) bytes += src.size();
+    cout << "基准测试: 单产生式归约消除，语料 " << corpus.size() << " 个程序，共 " << bytes << " 字节" << endl;
+
+    vector<vector<Quad>> outputs[2];
+    long long baseReductions = 0;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        GrammarAnalyzer G;
+        G.verbose = false;
+        G.loadGrammar(grammarFile);
+        if (!G.build())
+        {
+            cout << "文法不是 SLR(1) 文法" << endl;
+            return;
+        }
+        int rewritten = (mode == 1) ? G.eliminateUnitReductions() : 0;
+
+        Parser parser(G);
+        parser.verbose = false;
+        long long shifts = 0, reductions = 0;
+        double t = timeIt([&]() {
+            for (const auto& src : corpus)
+            {
+                if (!parser.parse(src)) continue;
+                shifts += parser.stats.shifts;
+                reductions += parser.stats.reductions;
+                outputs[mode].push_back(parser.result);
+            }
+        });
+        cout << (mode == 0 ? "[原分析表]" : "[消除后]  ") << " 改写表项 " << rewritten
+             << "，移进 " << shifts << " 次，归约 " << reductions << " 次，耗时 " << t << " s" << endl;
+        if (mode == 0) baseReductions = reductions;
+        if (mode == 1)
+        {
+            cout << "减少归约 " << baseReductions - reductions << " 次 ("
+                 << 100.0 * (baseReductions - reductions) / max(baseReductions, 1LL) << "%)，";
+            cout << "四元式" << (outputs[0] == outputs[1] ? "完全一致" : "不一致!") << endl;
+        }
+    }
+}
+
+void benchmarkDefaultReductions(const string& grammarFile)
+{
+    vector<string> corpus = generateCorpus(2000);
+    cout << "基准测试: 默认归约，语料 " << corpus.size() << " 个程序" << endl;
+
+    vector<vector<Quad>> outputs[2];
+    long long baseLookups = 0;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        GrammarAnalyzer G;
+        G.verbose = false;
+        G.loadGrammar(grammarFile);
+        if (!G.build())
+        {
+            cout << "文法不是 SLR(1) 文法" << endl;
+            return;
+        }
+        int marked = (mode == 1) ? G.markDefaultReductions() : 0;
+
+        Parser parser(G);
+        parser.verbose = false;
+        long long lookups = 0, defaults = 0;
+        double t = timeIt([&]() {
+            for (const auto& src : corpus)
+            {
+                if (!parser.parse(src)) continue;
+                lookups += parser.stats.tableLookups;
+                defaults += parser.stats.defaultReductions;
+                outputs[mode].push_back(parser.result);
+            }
+        });
+        cout << (mode == 0 ? "[原分析表]" : "[默认归约]") << " 默认归约状态 " << marked
+             << "，Action 表条目 " << G.actionEntryCount() << "，查表 " << lookups
+             << " 次，免查表归约 " << defaults << " 次，耗时 " << t << " s" << endl;
+        if (mode == 0) baseLookups = lookups;
+        if (mode == 1)
+        {
+            cout << "减少查表 " << baseLookups - lookups << " 次 ("
+                 << 100.0 * (baseLookups - lookups) / max(baseLookups, 1LL) << "%)，";
+            cout << "四元式" << (outputs[0] == outputs[1] ? "完全一致" : "不一致!") << endl;
+        }
+    }
+}
+
+// 覆盖 ratio 比例的查表所需的 64 字节缓存行数
+// hits 的键为 (剖析时的状态编号, 符号)，newId 把它映射到当前紧凑表中的状态编号
+static int hotCacheLines(const GrammarAnalyzer& G, const map<pair<int, string>, long long>& hits,
+                         const vector<int>& newId, double ratio)
+{
+    const PackedTable& P = G.packed;
+    vector<pair<long long, long long>> cells; // (次数, 字节地址)
+    long long total = 0;
+    // Goto 表放在 Action 表之后的独立地址空间，保证两者的缓存行不会重合
+    long long gotoBase = ((long long)P.action.size() * sizeof(Action) / 64 + 1) * 64;
+    for (const auto& h : hits)
+    {
+        int s = newId.empty() ? h.first.first : newId[h.first.first];
+        auto t = P.termCol.find(h.first.second);
+        long long addr;
+        if (t != P.termCol.end())
+            addr = ((long long)s * P.numTerms + t->second) * sizeof(Action);
+        else
+            addr = gotoBase + ((long long)s * P.numNonTerms + P.nonTermCol.at(h.first.second)) * sizeof(int);
+        cells.push_back({h.second, addr});
+        total += h.second;
+    }
+    sort(cells.rbegin(), cells.rend());
+
+    set<long long> lines;
+    long long covered = 0;
+    for (const auto& c : cells)
+    {
+        if (covered >= ratio * total) break;
+        covered += c.first;
+        lines.insert(c.second / 64);
+    }
+    return lines.size();
+}
+
+void benchmarkProfileRenumber(const string& grammarFile)
+{
+    vector<string> training = generateCorpus(2000, 7);
+    vector<string> corpus = generateCorpus(20000, 2024);
+    size_t bytes = 0;
+    for (const auto& src : corpus) bytes += src.size();
+    cout << "基准测试: 剖析引导的状态重编号，训练语料 " << training.size() << " 个程序，测试语料 "
+         << corpus.size() << " 个程序 (" << bytes << " 字节)" << endl;
+
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar(grammarFile);
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return;
+    }
+    G.packTables();
+    Parser parser(G);
+    parser.verbose = false;
+
+    // 在测试语料上解析 3 遍，取最短耗时
+    auto run = [&](vector<vector<Quad>>& out) -> double {
+        double best = 1e30;
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            out.clear();
+            best = min(best, timeIt([&]() {
+                for (const auto& src : corpus)
+                {
+                    if (parser.parse(src)) out.push_back(parser.result);
+                }
+            }));
+        }
+        return best;
+    };
+
+    vector<vector<Quad>> before, after;
+    double t0 = run(before);
+
+    // 1. 剖析
+    parser.profiling = true;
+    for (const auto& src : training) parser.parse(src);
+    parser.profiling = false;
+    const ParseProfile& prof = parser.profile;
+
+    cout << "最常用的转移:" << endl;
+    vector<pair<long long, pair<int, string>>> top;
+    for (const auto& h : prof.transitionHits) top.push_back({h.second, h.first});
+    sort(top.rbegin(), top.rend());
+    for (size_t i = 0; i < top.size() && i < 5; ++i)
+        cout << "  状态 " << top[i].second.first << " --" << top[i].second.second << "--> " << top[i].first << " 次" << endl;
+
+    const double ratios[] = {0.5, 0.9, 0.99};
+    int linesBefore[3], linesAfter[3];
+    for (int i = 0; i < 3; ++i) linesBefore[i] = hotCacheLines(G, prof.transitionHits, {}, ratios[i]);
+
+    // 2. 重编号并重新生成紧凑表
+    vector<int> newId = G.renumberStates(prof.stateHits, prof.terminalHits);
+    for (int i = 0; i < 3; ++i) linesAfter[i] = hotCacheLines(G, prof.transitionHits, newId, ratios[i]);
+
+    double t1 = run(after);
+
+    cout << "紧凑表大小: Action " << G.packed.action.size() * sizeof(Action) << " 字节，Goto "
+         << G.packed.goTo.size() * sizeof(int) << " 字节" << endl;
+    cout << "覆盖 50% / 90% / 99% 查表所需的缓存行:" << endl;
+    cout << "[重编号前] " << linesBefore[0] << " / " << linesBefore[1] << " / " << linesBefore[2]
+         << " 条，测试语料耗时 " << t0 << " s (" << bytes / t0 / 1e6 << " MB/s)" << endl;
+    cout << "[重编号后] " << linesAfter[0] << " / " << linesAfter[1] << " / " << linesAfter[2]
+         << " 条，测试语料耗时 " << t1 << " s (" << bytes / t1 / 1e6 << " MB/s)" << endl;
+    cout << "四元式" << (before == after ? "完全一致" : "不一致!") << endl;
+}
+
+bool checkPushParser(GrammarAnalyzer& G)
+{
+    vector<string> corpus = generateCorpus(500, 99);
+    mt19937 rng(12345);
+    Parser reference(G);
+    reference.verbose = false;
+    PushParser pp(G);
+
+    int runs = 0, mismatches = 0;
+    for (const auto& src : corpus)
+    {
+        if (!reference.parse(src)) continue;
+
+        // 1. 按随机字节块送入，块大小 1~16
+        for (int trial = 0; trial < 5; ++trial)
+        {
+            pp.reset();
+            size_t pos = 0;
+            while (pos < src.size())
+            {
+                size_t len = 1 + rng() % 16;
+                pp.feed(src.substr(pos, len));
+                pos += len;
+            }
+            runs++;
+            if (pp.finish() != PARSE_ACCEPT || pp.parser.result != reference.result) mismatches++;
+        }
+
+        // 2. 按随机批次送入 Token
+        Lexer lexer(src, &G.lexTable);
+        vector<Token> tokens = lexer.tokenize();
+        tokens.pop_back(); // 去掉结束符，由 finish() 送入
+        pp.reset();
+        size_t pos = 0;
+        while (pos < tokens.size())
+        {
+            size_t len = 1 + rng() % 4;
+            vector<Token> batch(tokens.begin() + pos, tokens.begin() + min(pos + len, tokens.size()));
+            pp.feed(batch);
+            pos += len;
+        }
+        runs++;
+        if (pp.finish() != PARSE_ACCEPT || pp.parser.result != reference.result) mismatches++;
+    }
+    cout << "推式分析器检查: " << runs << " 次分块分析，不一致 " << mismatches << " 次" << endl;
+    return mismatches == 0;
+}
+
+bool checkUserTempNames()
+{
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar("testfile_loop.txt");
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return false;
+    }
+
+    // 源程序中的变量与生成的临时变量、标号同名
+    vector<string> programs = {
+        "while ( T5 > b ) { x = a + T5 }",
+        "T1 = a + b T2 = 0 while ( T2 < T1 ) { T3 = T2 * 4 + c T2 = T2 + 1 } y = T3",
+        "i = 0 while ( i < n ) { T7 = b * c a = T7 + i * 3 i = i + 1 }",
+        "L1 = 0 while ( L1 < 9 ) { L2 = L1 * 2 + 1 L1 = L1 + 1 }",
+        "T2 = 0 while ( T2 < n ) { T1 = T2 * 8 + T1 T2 = T2 + 1 }",
+    };
+    // 把变量 Tn、Ln 改名为 Vn、Mn 后分析，两次结果应只相差这些变量名以及生成的名字的编号:
+    // 源程序中的变量原样保留，生成的名字一一对应，且不与源程序中的变量同名
+    auto rename = [](string s) {
+        for (char& c : s) 
+        {
+            if (c == 'T') c = 'V';
+            else if (c == 'L') c = 'M';
+        }
+        return s;
+    };
+    auto wordsOf = [](const string& src) {
+        set<string> words;
+        istringstream in(src);
+        for (string w; in >> w;) words.insert(w);
+        return words;
+    };
+    auto sameUpToGenerated = [&](const string& src, const vector<Quad>& direct, const vector<Quad>& renamed) {
+        if (direct.size() != renamed.size()) return false;
+        set<string> userNames = wordsOf(src), renamedNames = wordsOf(rename(src));
+        map<string, string> forward, backward;
+        for (size_t i = 0; i < direct.size(); ++i)
+        {
+            const string& op = direct[i].op;
+            if (op != renamed[i].op) return false;
+            // 跳转目标 (标号或序号) 与变量不在同一个名字空间，只要求一一对应
+            bool control = op == "label" || op[0] == 'j';
+            for (auto field : {&Quad::arg1, &Quad::arg2, &Quad::result})
+            {
+                const string& x = direct[i].*field;
+                const string& y = renamed[i].*field;
+                bool target = control && field == &Quad::result;
+                if (!target && userNames.count(x))
+                {
+                    if (y != rename(x)) return false;
+                }
+                else if ((!target && renamedNames.count(y)) || forward.emplace(x, y).first->second != y ||
+                         backward.emplace(y, x).first->second != x)
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    Parser parser(G);
+    parser.verbose = false;
+    int runs = 0, mismatches = 0;
+    // (复用临时变量, 循环优化, 回填)
+    vector<array<bool, 3>> modes = {{true, false, false}, {false, true, false}, {true, true, false}, {true, false, true}};
+    for (const auto& src : programs)
+    {
+        for (const auto& mode : modes)
+        {
+            parser.recycleTemps = mode[0];
+            parser.loopOpt = mode[1];
+            parser.backpatch = mode[2];
+            // 不复用时生成的临时变量按分析顺序编号，去掉前缀后可能与 Tn 同名 (与不优化时相同)，保留前缀比较
+            parser.placeholderNames = !mode[0];
+            if (!parser.parse(src)) return false;
+            vector<Quad> direct = parser.result;
+            if (!parser.parse(rename(src))) return false;
+            runs++;
+            if (!sameUpToGenerated(src, direct, parser.result)) 
+            {
+                mismatches++;
+                cout << "不一致: " << src << endl;
+            }
+        }
+    }
+    cout << "临时变量命名检查: " << runs << " 次分析，不一致 " << mismatches << " 次" << endl;
+    return mismatches == 0;
+}
+
+bool checkEmbeddedTable()
+{
+    EmbeddedTableView view;
+    if (!embeddedGrammar(view))
+    {
+        cout << "没有编译期分析表，请以 -std=c++20 编译" << endl;
+        return false;
+    }
+
+    // 启动耗时: 运行时构造 (读文法 + First/Follow + DFA + 分析表 + 紧凑表) 与装入编译期分析表
+    const int rounds = 200;
+    double tBuild = timeIt([&]() {
+        for (int i = 0; i < rounds; ++i)
+        {
+            GrammarAnalyzer R;
+            R.verbose = false;
+            R.loadGrammar("testfile.txt");
+            R.build();
+            R.packTables();
+        }
+    });
+    double tEmbed = timeIt([&]() {
+        for (int i = 0; i < rounds; ++i)
+        {
+            GrammarAnalyzer E;
+            E.loadEmbedded(view);
+        }
+    });
+    cout << "启动耗时: 运行时构造 " << tBuild / rounds * 1e6 << " us，装入编译期分析表 "
+         << tEmbed / rounds * 1e6 << " us" << endl;
+
+    GrammarAnalyzer R, E;
+    R.verbose = false;
+    R.loadGrammar("testfile.txt");
+    if (!R.build()) return false;
+    R.packTables();
+    E.loadEmbedded(view);
+
+    bool same = R.states.size() == E.states.size() && R.startSymbol == E.startSymbol
+        && R.grammar.size() == E.grammar.size() && R.packed.termCol == E.packed.termCol
+        && R.packed.nonTermCol == E.packed.nonTermCol && R.packed.goTo == E.packed.goTo
+        && R.packed.action.size() == E.packed.action.size();
+    for (size_t i = 0; same && i < R.grammar.size(); ++i)
+        same = R.grammar[i].lhs == E.grammar[i].lhs && R.grammar[i].rhs == E.grammar[i].rhs;
+    for (size_t i = 0; same && i < R.packed.action.size(); ++i)
+        same = R.packed.action[i].type == E.packed.action[i].type && R.packed.action[i].val == E.packed.action[i].val;
+    cout << "分析表 (" << E.states.size() << " 个状态，" << E.packed.numTerms << " 个终结符列，"
+         << E.packed.numNonTerms << " 个非终结符列)" << (same ? "完全一致" : "不一致!") << endl;
+
+    int runs = 0, mismatches = 0;
+    Parser pr(R), pe(E);
+    pr.verbose = pe.verbose = false;
+    for (const auto& src : generateCorpus(200, 7))
+    {
+        bool okR = pr.parse(src), okE = pe.parse(src);
+        runs++;
+        if (okR != okE || pr.result != pe.result) mismatches++;
+    }
+    cout << "随机语料 " << runs << " 个程序，四元式不一致 " << mismatches << " 个" << endl;
+    return same && mismatches == 0;
+}
+
+void benchmarkParallel(int megabytes)
+{
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar("testfile_seq.txt");
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return;
+    }
+
+    // 顶层语句序列: 随机语料逐条拼接
+    size_t want = (size_t)megabytes << 20;
+    string src;
+    mt19937 rng(2024);
+    while (src.size() < want)
+        src += randomStmt(rng, 1 + rng() % 8) + "\n";
+    int hw = max(1u, thread::hardware_concurrency());
+    cout << "基准测试: 并行分析，源文件 " << src.size() << " 字节，硬件线程数 " << hw << endl;
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        cout << (mode == 0 ? "[普通模式]" : "[回填模式]") << endl;
+        Parser serial(G);
+        serial.verbose = false;
+        serial.backpatch = (mode == 1);
+        bool ok = false;
+        double tSerial = timeIt([&]() { ok = serial.parse(src); });
+        if (!ok) return;
+        cout << "  串行: " << tSerial << " s, 四元式 " << serial.result.size() << " 条" << endl;
+
+        for (int threads = 1; threads <= max(hw, 4); threads *= 2)
+        {
+            ParallelParser pp(G, threads);
+            pp.backpatch = (mode == 1);
+            double t = timeIt([&]() { ok = pp.parse(src); });
+            cout << "  " << threads << " 线程: " << t << " s (" << pp.chunks << " 块), 加速比 "
+                 << tSerial / t << "x" << (ok && pp.result == serial.result ? "，结果一致" : "，结果不一致!") << endl;
+        }
+    }
+}
+
+void benchmarkLexer(const string& grammarFile)
+{
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar(grammarFile);
+    if (!G.lexTable.ready)
+    {
+        cout << "文法文件中没有可用的 %token 定义" << endl;
+        return;
+    }
+    const LexTable& T = G.lexTable;
+    cout << "基准测试: 词法分析，生成的 DFA " << T.numStates << " 个状态，" << T.numClasses
+         << " 个字节等价类，转移表 " << T.next.size() * sizeof(int) << " 字节" << endl;
+
+    vector<string> corpus = generateCorpus(20000);
+    string all;
+    for (const auto& src : corpus) all += src + "\n";
+
+    vector<Token> tokens[2];
+    double best[2] = {1e30, 1e30};
+    for (int rep = 0; rep < 3; ++rep)
+    {
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            best[mode] = min(best[mode], timeIt([&]() {
+                Lexer lexer(all, mode == 1 ? &T : nullptr);
+                tokens[mode] = lexer.tokenize();
+            }));
+        }
+    }
+    bool same = tokens[0].size() == tokens[1].size();
+    for (size_t i = 0; same && i < tokens[0].size(); ++i)
+        same = tokens[0][i].type == tokens[1][i].type && tokens[0][i].value == tokens[1][i].value;
+    double mb = all.size() / 1048576.0;
+    cout << "[手写规则] " << best[0] << " s (" << mb / best[0] << " MB/s)" << endl;
+    cout << "[生成的表] " << best[1] << " s (" << mb / best[1] << " MB/s)" << endl;
+    cout << tokens[1].size() << " 个 Token，" << (same ? "Token 序列完全一致" : "Token 序列不一致!") << endl;
+}
+
+void benchmarkLoops()
+{
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar("testfile_loop.txt");
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return;
+    }
+
+    const long long n = 300, m = 300;
+    // (程序, 最内层循环的迭代次数)
+    vector<pair<string, long long>> kernels = {
+        {"i = 0 while ( i < n ) { i = i + 1 }", n},
+        {"i = 0 while ( i < n ) { a = b * c + i * 3 i = i + 1 }", n},
+        {"i = 0 s = 0 while ( i < n ) { j = 0 while ( j < m ) { s = s + i * 8 + j * 4 + k * 2 j = j + 1 } i = i + 1 }", n * m},
+    };
+    cout << "基准测试: 循环优化 (n = " << n << ", m = " << m << ")" << endl;
+
+    Parser parser(G);
+    parser.verbose = false;
+    parser.placeholderNames = true; // 循环优化靠保留前缀识别生成的临时变量
+    for (const auto& kernel : kernels)
+    {
+        if (!parser.parse(kernel.first)) return;
+        vector<Quad> code[2] = {parser.result, parser.result};
+        LoopOptStats ls = optimizeLoops(code[1]);
+        for (auto& c : code) rebaseQuads(c, 0, 0, 0);
+        cout << kernel.first << endl;
+        cout << "  " << ls.loops << " 个循环，外提 " << ls.hoisted << " 条，强度削弱 " << ls.reduced
+             << " 条，倒置 " << ls.inverted << " 个" << endl;
+
+        vector<long long> env[2];
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            LoweredProgram prog;
+            string err;
+            if (!lowerQuads(code[mode], prog, err))
+            {
+                cout << "  翻译失败: " << err << endl;
+                return;
+            }
+            vector<long long> e(prog.slotNames.size(), 0);
+            auto set = [&](const string& name, long long v) {
+                int slot = prog.slotOf(name);
+                if (slot >= 0) e[slot] = v;
+            };
+            set("n", n);
+            set("m", m);
+            set("b", 5);
+            set("c", 7);
+            set("k", 11);
+            vector<long long> init = e;
+
+            vector<long long> opCounts;
+            Interpreter interp(prog);
+            long long executed = interp.run(e, &opCounts);
+            cout << "  " << (mode == 0 ? "[优化前]" : "[优化后]") << " 四元式 " << code[mode].size() << " 条，执行指令 "
+                 << executed << " 条 (每次迭代 " << (double)executed / kernel.second << ")，乘法 " << opCounts[OP_MUL]
+                 << " 次，跳转 " << opCounts[OP_JFALSE] + opCounts[OP_JTRUE] + opCounts[OP_JUMP] << " 次";
+
+            if (NativeCode::supported())
+            {
+                NativeCode native;
+                if (native.compile(prog, err))
+                {
+                    native.run(init);
+                    cout << (init == e ? "，本地代码结果一致" : "，本地代码结果不一致!");
+                }
+            }
+            cout << endl;
+
+            // 按变量名记录用户变量的结果，用于比较优化前后
+            for (const char* v : {"i", "j", "s", "a"})
+            {
+                int slot = prog.slotOf(v);
+                env[mode].push_back(slot >= 0 ? e[slot] : 0);
+            }
+        }
+        cout << "  用户变量结果" << (env[0] == env[1] ? "一致" : "不一致!") << endl;
+    }
+}
+
+void benchmarkLazy(const string& grammarFile, int families)
+{
+    setMemoryTracking(true);
+    ifstream file(grammarFile);
+    string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    text += "\n";
+    for (int k = 0; k < families; ++k)
+    {
+        string kw = "kw" + to_string(k), C = "C" + to_string(k), E = "E" + to_string(k);
+        text += "S -> " + kw + " ( " + C + " ) { S }\n";
+        text += "S -> " + kw + " id = " + E + " ;\n";
+        text += C + " -> " + E + " > " + E + "\n";
+        text += C + " -> " + E + " == " + E + "\n";
+        text += E + " -> id + " + E + "\n";
+        text += E + " -> num * " + E + "\n";
+        text += E + " -> ( " + E + " )\n";
+        text += E + " -> id\n";
+        text += E + " -> num\n";
+    }
+    vector<string> corpus = generateCorpus(2000);
+
+    GrammarAnalyzer* G[2] = {nullptr, nullptr};
+    double tBuild[2];
+    PhaseMemory mem[2];
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        {
+            MemoryPhase phase(mode == 0 ? "立即构建" : "惰性构建");
+            tBuild[mode] = timeIt([&]() {
+                G[mode] = new GrammarAnalyzer;
+                G[mode]->verbose = false;
+                stringstream in(text);
+                G[mode]->loadGrammar(in);
+                if (mode == 0) G[mode]->build();
+                else G[mode]->buildLazy();
+            });
+        }
+        mem[mode] = memoryReport().back();
+    }
+    cout << "基准测试: 惰性构建，文法 " << G[0]->grammar.size() << " 条产生式，完整 DFA " << G[0]->states.size()
+         << " 个状态，语料 " << corpus.size() << " 个程序" << endl;
+
+    vector<vector<Quad>> results[2];
+    double tParse[2];
+    PhaseMemory parseMem[2];
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        Parser parser(*G[mode]);
+        parser.verbose = false;
+        {
+            // 惰性模式下分析期间新增的保留内存即按需计算的行
+            MemoryPhase phase("语料分析");
+            tParse[mode] = timeIt([&]() {
+                for (const auto& src : corpus) parser.parse(src);
+            });
+        }
+        parseMem[mode] = memoryReport().back();
+        for (const auto& src : corpus)
+        {
+            parser.parse(src);
+            results[mode].push_back(parser.result);
+        }
+    }
+
+    int rows = 0;
+    for (char r : G[1]->rowReady) rows += r;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        cout << (mode == 0 ? "[立即构建]" : "[惰性构建]") << " 启动 " << tBuild[mode] * 1e3 << " ms，保留 "
+             << mem[mode].retained << " B，峰值 " << mem[mode].peakBytes << " B；分析语料 " << tParse[mode] * 1e3
+             << " ms，其间新增保留 " << parseMem[mode].retained << " B" << endl;
+    }
+    cout << "惰性模式计算了 " << rows << " 行，创建了 " << G[1]->states.size() << " 个状态 (完整 DFA 为 "
+         << G[0]->states.size() << " 个)" << endl;
+    cout << "四元式" << (results[0] == results[1] ? "完全一致" : "不一致!") << endl;
+    delete G[0];
+    delete G[1];
+}
+
+void benchmarkIncremental()
+{
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar("testfile_seq.txt");
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return;
+    }
+    const int rounds = 20;
+    cout << "基准测试: 增量分析，每种大小做 " << rounds * 4 << " 次随机修改 (四种各 " << rounds << " 次)" << endl;
+
+    for (int kb : {64, 256, 1024})
+    {
+        mt19937 rng(kb);
+        string src;
+        while (src.size() < (size_t)kb << 10)
+            src += randomStmt(rng, 1 + rng() % 8) + "\n";
+
+        IncrementalParser inc(G);
+        Parser full(G);
+        full.verbose = false;
+        double tInit = timeIt([&]() { inc.parse(src); });
+
+        // [0] 普通修改 (改数字、插入语句、删除语句)，[1] 删掉一个 '}' 再补回
+        double tInc[2] = {0, 0}, tAssemble[2] = {0, 0}, tFull[2] = {0, 0};
+        size_t relexed[2] = {0, 0};
+        int count[2] = {0, 0};
+        int mismatches = 0;
+        for (int e = 0; e < rounds * 4; ++e)
+        {
+            const string& cur = inc.source();
+            size_t pos = rng() % cur.size();
+            size_t b = pos, end = pos;
+            string text;
+            int kind = e % 4;
+            if (kind == 0)
+            {
+                // 把一个数字改成另一个数字
+                while (b < cur.size() && !isdigit((unsigned char)cur[b])) b++;
+                if (b == cur.size()) b = 0;
+                end = b + (b < cur.size() && isdigit((unsigned char)cur[b]) ? 1 : 0);
+                text = to_string(rng() % 10);
+            }
+            else if (kind == 1)
+            {
+                // 在下一行的开头插入一条语句
+                size_t nl = cur.find('\n', pos);
+                b = end = (nl == string::npos ? cur.size() : nl + 1);
+                text = randomStmt(rng, 1 + rng() % 4) + "\n";
+            }
+            else if (kind == 2)
+            {
+                // 删除一行
+                size_t nl = cur.find('\n', pos);
+                b = (nl == string::npos ? 0 : nl + 1);
+                size_t nl2 = cur.find('\n', b);
+                end = (nl2 == string::npos ? cur.size() : nl2 + 1);
+                if (end - b == cur.size()) end = b;
+            }
+            else
+            {
+                // 删掉一个 '}'，整体分析失败后再补回
+                b = cur.find('}', pos);
+                if (b == string::npos) b = cur.find('}');
+                end = b + 1;
+            }
+            int group = kind == 3 ? 1 : 0;
+            for (int step = 0; step < (kind == 3 ? 2 : 1); ++step)
+            {
+                // 增量分析计到取得重新分析的各段 (已按整体序列编号) 的四元式为止，完整拼接单独计时
+                bool okInc = false, okFull = false;
+                vector<Quad> changed, code;
+                tInc[group] += timeIt([&]() {
+                    okInc = step == 0 ? inc.edit(b, end, text) : inc.edit(b, b, "}");
+                    for (int k = inc.firstReparsed; k < inc.firstReparsed + inc.reparsed; ++k)
+                    {
+                        vector<Quad> piece = inc.fragmentCode(k);
+                        changed.insert(changed.end(), piece.begin(), piece.end());
+                    }
+                });
+                if (okInc) tAssemble[group] += timeIt([&]() { code = inc.assemble(); });
+                relexed[group] += inc.relexedBytes;
+                count[group]++;
+                tFull[group] += timeIt([&]() { okFull = full.parse(inc.source()); });
+                if (okInc != okFull || (okFull && code != full.result)) mismatches++;
+
+                // 按段取出的四元式依次拼接也应与整体结果相同
+                if (okFull)
+                {
+                    vector<Quad> pieces;
+                    for (int k = 0; k < inc.fragmentCount(); ++k)
+                    {
+                        vector<Quad> piece = inc.fragmentCode(k);
+                        pieces.insert(pieces.end(), piece.begin(), piece.end());
+                    }
+                    if (pieces != full.result) mismatches++;
+                }
+            }
+        }
+        cout << "  " << inc.source().size() << " 字节，" << inc.fragmentCount() << " 段，首次分析 " << tInit * 1e3
+             << " ms，结果" << (mismatches == 0 ? "完全一致" : "不一致 " + to_string(mismatches) + " 次!") << endl;
+        for (int group = 0; group < 2; ++group)
+        {
+            cout << (group == 0 ? "    普通修改:     " : "    破坏/修复括号: ") << "整体重新分析 " << tFull[group] / count[group] * 1e3
+                 << " ms，增量分析并取出改动段 " << tInc[group] / count[group] * 1e3 << " ms (平均重新分析 "
+                 << relexed[group] / count[group] << " 字节)，完整拼接 " << tAssemble[group] / count[group] * 1e3
+                 << " ms" << endl;
+        }
+    }
+}
+
+void benchmarkStream()
+{
+    setMemoryTracking(true);
+    GrammarAnalyzer G;
+    G.verbose = false;
+    G.loadGrammar("testfile_seq.txt");
+    if (!G.build())
+    {
+        cout << "文法不是 SLR(1) 文法" << endl;
+        return;
+    }
+    const size_t chunk = 4096;
+    cout << "基准测试: 流式输出四元式，源代码按 " << chunk << " 字节分块送入推式分析器" << endl;
+
+    for (int bp = 0; bp < 2; ++bp)
+    {
+        cout << (bp == 0 ? "[普通模式]" : "[回填模式]") << endl;
+        for (int kb : {256, 1024, 4096})
+        {
+            mt19937 rng(kb);
+            string src;
+            while (src.size() < (size_t)kb << 10)
+                src += randomStmt(rng, 1 + rng() % 8) + "\n";
+
+            // 非流式: 接受时才得到完整的四元式序列
+            PushParser pp(G);
+            pp.parser.verbose = false;
+            pp.parser.backpatch = bp == 1;
+            double tFull;
+            {
+                MemoryPhase phase("整体输出");
+                tFull = timeIt([&]() {
+                    for (size_t i = 0; i < src.size(); i += chunk) pp.feed(src.substr(i, chunk));
+                    pp.finish();
+                });
+            }
+            PhaseMemory fullMem = memoryReport().back();
+            vector<Quad> expected = move(pp.parser.result);
+
+            // 流式: 边分析边与 expected 逐条比较，不保留四元式
+            PushParser sp(G);
+            sp.parser.verbose = false;
+            sp.parser.backpatch = bp == 1;
+            size_t n = 0;
+            int mismatches = 0;
+            size_t firstAt = 0; // 送出第一条四元式时已送入的字节数
+            size_t fed = 0;
+            sp.parser.sink = [&](const Quad& q) {
+                if (n >= expected.size() || !(q == expected[n])) mismatches++;
+                if (n++ == 0) firstAt = fed;
+            };
+            double tStream;
+            {
+                MemoryPhase phase("流式输出");
+                tStream = timeIt([&]() {
+                    for (size_t i = 0; i < src.size(); i += chunk)
+                    {
+                        fed = min(src.size(), i + chunk);
+                        sp.feed(src.substr(i, chunk));
+                    }
+                    sp.finish();
+                });
+            }
+            PhaseMemory streamMem = memoryReport().back();
+            if (n != expected.size()) mismatches++;
+
+            cout << "  " << src.size() << " 字节，" << expected.size() << " 条四元式: 整体输出 " << tFull * 1e3
+                 << " ms，峰值 " << fullMem.peakBytes << " B；流式输出 " << tStream * 1e3 << " ms，峰值 "
+                 << streamMem.peakBytes << " B，第一条在送入 " << firstAt << " 字节时输出，结果"
+                 << (mismatches == 0 ? "完全一致" : "不一致 " + to_string(mismatches) + " 处!") << endl;
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "common.h"
+#include "grammar.h"
+
+/**
+ * @brief 本地代码后端与字节码解释器的性能对比
+ * 对循环内核 while ( i < n ) { i = i + 1 } 分别在普通模式和回填模式下生成四元式，
+ * 用两种方式执行并比较耗时和结果
+ * @param G 已构建好分析表的文法分析器
+ */
+void benchmarkNative(GrammarAnalyzer& G);
+
+/**
+ * @brief 生成随机测试语料
+ * 每个程序是一条语句: 随机嵌套的 while 循环，最内层为赋值，表达式为 id/num 用 + 连接
+ * @param count 程序个数
+ * @param seed 随机种子，相同种子生成相同语料
+ */
+vector<string> generateCorpus(int count, unsigned seed = 2024);
+
+/**
+ * @brief 单产生式归约消除的效果
+ * 在随机语料上对比消除前后的归约次数、耗时，并检查生成的四元式一致
+ * @param grammarFile 文法文件
+ */
+void benchmarkUnitElimination(const string& grammarFile);
+
+/**
+ * @brief 默认归约的效果
+ * 在随机语料上对比标记默认归约前后的查表次数、Action 表大小和耗时，并检查生成的四元式一致
+ * @param grammarFile 文法文件
+ */
+void benchmarkDefaultReductions(const string& grammarFile);
+
+/**
+ * @brief 剖析引导的状态重编号
+ * 在训练语料上剖析状态/转移的访问次数，按频率重排状态编号和终结符列，
+ * 对比重排前后紧凑表上覆盖 99% 查表所需的缓存行数，以及在大语料上的吞吐量
+ * @param grammarFile 文法文件
+ */
+void benchmarkProfileRenumber(const string& grammarFile);
+
+/**
+ * @brief 检查推式分析器与整体分析的结果一致
+ * 把随机语料按随机的块边界 (可以落在 Token 中间) 分块送入 PushParser，
+ * 同时也按随机批次送入 Token，检查生成的四元式与 Parser::parse() 完全一致
+ * @param G 已构建好分析表的文法分析器
+ * @return 全部一致返回 true
+ */
+bool checkPushParser(GrammarAnalyzer& G);
+
+/**
+ * @brief 检查生成的名字不与源程序中的变量混淆
+ * 用文法 testfile_loop.txt 分析变量名形如 T3、L1 的程序 (与生成的临时变量、标号同名)，
+ * 在临时变量复用、循环优化和回填模式下，检查结果与把这些变量改名后分析的结果完全对应
+ * @return 全部一致返回 true
+ */
+bool checkUserTempNames();
+
+/**
+ * @brief 检查编译期生成的分析表 (embeddedGrammar()) 与运行时 build() 的结果一致
+ * 对比产生式、紧凑表的列号与每个表项，并在随机语料上对比生成的四元式；同时给出两种方式的启动耗时
+ * @return 一致返回 true，以 C++20 之前的标准编译时返回 false
+ */
+bool checkEmbeddedTable();
+
+/**
+ * @brief 并行分析的效果
+ * 用文法 testfile_seq.txt 把随机语料拼成一个由大量顶层语句组成的大源文件，
+ * 在普通模式和回填模式下对比串行分析与不同线程数的并行分析的耗时，并检查四元式完全一致
+ * @param megabytes 源文件的大致大小 (MB)
+ */
+void benchmarkParallel(int megabytes);
+
+/**
+ * @brief 生成的词法分析器与手写词法分析器的对比
+ * 在随机语料上检查两者产生的 Token 序列一致，并比较扫描吞吐量
+ * @param grammarFile 含 %token 定义的文法文件
+ */
+void benchmarkLexer(const string& grammarFile);
+
+/**
+ * @brief 循环优化的效果
+ * 用文法 testfile_loop.txt 生成若干循环内核的四元式，优化前后分别解释执行，
+ * 对比执行的指令条数、乘法次数和每次最内层迭代的指令数，并检查结果一致 (支持时也用本地代码验证)
+ */
+void benchmarkLoops();
+
+/**
+ * @brief 惰性构建与立即构建的对比
+ * 在 grammarFile 的基础上追加 families 组互不相关的语句 (各自的关键字与条件/表达式非终结符)，
+ * 得到一个很大的文法，而随机语料只用到原文法的部分。
+ * 对比 build() 与 buildLazy() 的启动耗时、保留内存和峰值内存，分析语料后统计惰性模式实际计算的行数，
+ * 并检查两种模式生成的四元式一致
+ * @param grammarFile 基础文法文件
+ * @param families 追加的语句组数
+ */
+void benchmarkLazy(const string& grammarFile, int families);
+
+/**
+ * @brief 增量分析的效果
+ * 用文法 testfile_seq.txt 生成不同大小的源文件，做一系列随机修改 (改数字、插入语句、删除语句、
+ * 删掉一个 '}' 再补回)，每次修改后对比 IncrementalParser::edit() 加 fragmentCode() 取出重新分析各段的四元式
+ * 与整体重新分析的耗时 (assemble() 拼接完整序列另外计时)，并检查拼接后的四元式、逐段取出的四元式
+ * (以及成功与否) 与整体分析完全一致
+ */
+void benchmarkIncremental();
+
+/**
+ * @brief 流式输出四元式的效果
+ * 用文法 testfile_seq.txt 生成不同大小的源文件，分块送入推式分析器，
+ * 对比接受时一次取得全部四元式与设置 Parser::sink 边分析边输出的耗时、峰值内存和第一条四元式输出的时机，
+ * 普通模式与回填模式各做一遍，并检查流式输出的序列与整体输出完全一致
+ */
+void benchmarkStream();
+
+#endif
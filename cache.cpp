@@ -0,0 +1,217 @@
+#include "cache.h"
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+CompileCache::CompileCache(const GrammarAnalyzer& G, const string& directory,
+                           size_t memEntries, size_t diskBytes)
+    : dir(directory), maxMemEntries(memEntries), maxDiskBytes(diskBytes), diskTotal(0),
+      memHits(0), diskHits(0), misses(0), memEvictions(0), diskEvictions(0)
+{
+    // 文法哈希: 依次哈希每条产生式、优先级声明和词法定义的文本
+    // 优先级与结合性会改变冲突的消解方式，从而改变分析表和生成的四元式
+    grammarHash = hash("");
+    for (const auto& p : G.grammar) 
+        grammarHash = hash(p.toString() + "\n", grammarHash);
+    for (const auto& pr : G.precedence) 
+        grammarHash = hash("%prec " + pr.first + " " + to_string(pr.second.first) + " " + pr.second.second + "\n", grammarHash);
+    for (const auto& d : G.tokenDefs) 
+        grammarHash = hash((d.skip ? "%skip " : "%token " + d.name + " ") + d.pattern + "\n", grammarHash);
+
+    error_code ec;
+    fs::create_directories(dir, ec);
+    scanDisk();
+}
+
+uint64_t CompileCache::hash(const string& data, uint64_t seed) 
+{
+    uint64_t h = seed;
+    for (unsigned char c : data) 
+    {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+string CompileCache::makeKey(const Parser& parser, const string& source) const 
+{
+    // 代码生成选项会改变输出，也必须纳入键中
+    string options = string(parser.backpatch ? "b" : "-") + (parser.recycleTemps ? "r" : "-") + (parser.loopOpt ? "o" : "-");
+    uint64_t h = hash(source, grammarHash);
+    h = hash(options, h);
+
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
+    return buf;
+}
+
+void CompileCache::putMemory(const string& key, const string& source, const vector<Quad>& code) 
+{
+    auto it = index.find(key);
+    if (it != index.end()) 
+    {
+        // 同一个键下的新内容 (哈希碰撞) 替换旧条目
+        it->second->source = source;
+        it->second->code = code;
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.push_front({key, source, code});
+    index[key] = lru.begin();
+    while (lru.size() > maxMemEntries) 
+    {
+        index.erase(lru.back().key);
+        lru.pop_back();
+        memEvictions++;
+    }
+}
+
+/**
+ * 磁盘文件格式:
+ * 第一行: SLRQ2 <源代码字节数> <四元式条数>
+ * 之后是源代码的原始字节和一个换行
+ * 之后每行一个四元式，四个字段以制表符分隔
+ */
+bool CompileCache::loadDisk(const string& key, const string& source, vector<Quad>& code) 
+{
+    auto file = diskIndex.find(key);
+    if (file == diskIndex.end()) return false;
+    string path = dir + "/" + key + ".quad";
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+
+    string magic;
+    size_t size = 0, count = 0;
+    in >> magic >> size >> count;
+    if (magic != "SLRQ2" || size != source.size()) return false;
+    in.ignore(1, '\n');
+
+    // 键相同但源代码不同 (哈希碰撞) 视为未命中
+    string stored(size, '\0');
+    if (!in.read(&stored[0], size) || stored != source) return false;
+    in.ignore(1, '\n');
+
+    code.clear();
+    string line;
+    while (code.size() < count && getline(in, line)) 
+    {
+        stringstream ss(line);
+        Quad q;
+        getline(ss, q.op, '\t');
+        getline(ss, q.arg1, '\t');
+        getline(ss, q.arg2, '\t');
+        getline(ss, q.result, '\t');
+        code.push_back(q);
+    }
+    if (code.size() != count) return false;
+
+    // 移到磁盘 LRU 表头，并更新修改时间，供下次启动时恢复使用先后
+    diskLru.splice(diskLru.begin(), diskLru, file->second);
+    error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+void CompileCache::storeDisk(const string& key, const string& source, const vector<Quad>& code) 
+{
+    string path = dir + "/" + key + ".quad";
+    uintmax_t bytes;
+    {
+        ofstream out(path, ios::binary);
+        if (!out) return;
+        out << "SLRQ2 " << source.size() << " " << code.size() << "\n" << source << "\n";
+        for (const auto& q : code) 
+            out << q.op << '\t' << q.arg1 << '\t' << q.arg2 << '\t' << q.result << '\n';
+        bytes = out.tellp();
+    }
+
+    // 同一个键的旧文件 (哈希碰撞) 已被覆盖，先减去它的大小
+    auto file = diskIndex.find(key);
+    if (file != diskIndex.end()) 
+    {
+        diskTotal -= file->second->bytes;
+        diskLru.erase(file->second);
+    }
+    diskLru.push_front({key, bytes});
+    diskIndex[key] = diskLru.begin();
+    diskTotal += bytes;
+    evictDisk();
+}
+
+void CompileCache::scanDisk() 
+{
+    // 只在启动时遍历一次目录，按修改时间从新到旧建立磁盘 LRU
+    error_code ec;
+    vector<pair<fs::file_time_type, DiskFile>> files;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) 
+    {
+        if (entry.path().extension() != ".quad") continue;
+        uintmax_t bytes = entry.file_size(ec);
+        if (ec) continue;
+        files.push_back({entry.last_write_time(ec), {entry.path().stem().string(), bytes}});
+    }
+    sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (auto& f : files) 
+    {
+        diskTotal += f.second.bytes;
+        diskLru.push_back(move(f.second));
+        diskIndex[diskLru.back().key] = prev(diskLru.end());
+    }
+    evictDisk();
+}
+
+void CompileCache::evictDisk() 
+{
+    // 从最久未使用的文件开始删除，直到总大小不超过上限 (刚写入的文件在表头，最后才会删除)
+    error_code ec;
+    while (diskTotal > maxDiskBytes && !diskLru.empty()) 
+    {
+        const DiskFile& f = diskLru.back();
+        if (fs::remove(dir + "/" + f.key + ".quad", ec)) diskEvictions++;
+        diskTotal -= f.bytes;
+        diskIndex.erase(f.key);
+        diskLru.pop_back();
+    }
+}
+
+bool CompileCache::compile(Parser& parser, const string& source, vector<Quad>& out) 
+{
+    string key = makeKey(parser, source);
+
+    // 1. 内存命中
+    auto it = index.find(key);
+    if (it != index.end() && it->second->source == source) 
+    {
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->code;
+        memHits++;
+        return true;
+    }
+
+    // 2. 磁盘命中，同时放入内存
+    if (loadDisk(key, source, out)) 
+    {
+        putMemory(key, source, out);
+        diskHits++;
+        return true;
+    }
+
+    // 3. 未命中，执行完整的分析和代码生成
+    misses++;
+    if (!parser.parse(source)) return false;
+    out = parser.result;
+    putMemory(key, source, out);
+    storeDisk(key, source, out);
+    return true;
+}
+
+void CompileCache::printStats() const 
+{
+    cout << "编译缓存: 内存命中 " << memHits << "，磁盘命中 " << diskHits
+         << "，未命中 " << misses << "，内存淘汰 " << memEvictions
+         << "，磁盘淘汰 " << diskEvictions << endl;
+}
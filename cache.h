@@ -0,0 +1,95 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "common.h"
+#include "grammar.h"
+#include "parser.h"
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * @brief 以内容寻址的编译结果缓存
+ *
+ * 键为 (源代码字节, 文法, 代码生成选项) 的 64 位 FNV-1a 哈希。
+ * 条目同时保存完整的源代码，命中时逐字节比较，哈希碰撞不会返回另一个程序的四元式。
+ * 两级存储:
+ * - 内存: 按条目数限制的 LRU
+ * - 磁盘: 目录中每个键一个 <key>.quad 文件，按总字节数限制，超出时删除最久未使用的文件。
+ *   启动时扫描一次目录，建立各文件大小与使用先后的索引，之后的写入、命中和淘汰只维护这份索引，不再遍历目录
+ *   (文件修改时间仍随命中更新，供下次启动时恢复使用先后)
+ * 命中时直接返回四元式，跳过词法分析、语法分析和代码生成。
+ */
+class CompileCache 
+{
+    struct Entry
+    {
+        string key;
+        string source;      // 完整的源代码，命中时与请求逐字节比较
+        vector<Quad> code;
+    };
+    typedef list<Entry> LruList;
+
+    struct DiskFile
+    {
+        string key;
+        uintmax_t bytes;    // 文件大小
+    };
+    typedef list<DiskFile> DiskList;
+
+    string dir;              // 磁盘缓存目录
+    size_t maxMemEntries;    // 内存中最多保留的条目数
+    size_t maxDiskBytes;     // 磁盘缓存的总字节数上限
+    uint64_t grammarHash;    // 文法的哈希，文法变化时所有旧结果自动失效
+
+    LruList lru;                                        // 最近使用的在表头
+    unordered_map<string, LruList::iterator> index;     // 键 -> LRU 节点
+
+    DiskList diskLru;                                     // 磁盘上的文件，最近使用的在表头
+    unordered_map<string, DiskList::iterator> diskIndex;  // 键 -> 磁盘 LRU 节点
+    uintmax_t diskTotal;                                  // 磁盘上缓存文件的总字节数
+
+    string makeKey(const Parser& parser, const string& source) const;
+    void putMemory(const string& key, const string& source, const vector<Quad>& code);
+    bool loadDisk(const string& key, const string& source, vector<Quad>& code);
+    void storeDisk(const string& key, const string& source, const vector<Quad>& code);
+    void scanDisk();
+    void evictDisk();
+
+public:
+    // 统计计数
+    long long memHits;       // 内存命中次数
+    long long diskHits;      // 磁盘命中次数
+    long long misses;        // 未命中 (实际执行了分析) 的次数
+    long long memEvictions;  // 内存淘汰条目数
+    long long diskEvictions; // 磁盘淘汰文件数
+
+    /**
+     * @param G 已构建好分析表的文法分析器，用于计算文法哈希
+     * @param directory 磁盘缓存目录，不存在时自动创建
+     * @param memEntries 内存 LRU 的条目上限
+     * @param diskBytes 磁盘缓存的字节上限
+     */
+    CompileCache(const GrammarAnalyzer& G, const string& directory,
+                 size_t memEntries = 256, size_t diskBytes = 64 << 20);
+
+    /**
+     * @brief 计算 64 位 FNV-1a 哈希
+     */
+    static uint64_t hash(const string& data, uint64_t seed = 1469598103934665603ULL);
+
+    /**
+     * @brief 经过缓存编译源代码
+     * 先查内存，再查磁盘，都未命中时调用 parser.parse() 并写入两级缓存
+     * @param out 编译得到的四元式
+     * @return 编译成功 (或命中) 返回 true
+     */
+    bool compile(Parser& parser, const string& source, vector<Quad>& out);
+
+    /**
+     * @brief 打印命中/未命中/淘汰计数
+     */
+    void printStats() const;
+};
+
+#endif
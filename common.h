@@ -26,8 +26,21 @@ struct Quad
     {
         return "(" + op + ", " + arg1 + ", " + arg2 + ", " + result + ")";
     }
+
+    bool operator==(const Quad& other) const 
+    {
+        return op == other.op && arg1 == other.arg1 && arg2 == other.arg2 && result == other.result;
+    }
 };
 
+/**
+ * @brief 编号名字的保留前缀
+ * 生成的临时变量与标号写作 kGeneratedMark + "T3"、kGeneratedMark + "L2" (见 Parser::placeholderNames)，
+ * 词法分析器不会产生以控制字符开头的标识符，因此与源程序中名为 T3、L2 的变量区分开，
+ * 由 rebaseQuads() 换成最终的编号
+ */
+const char kGeneratedMark = '\x01';
+
 /**
  * @brief 产生式结构体
  * 表示文法中的一条规则，如 S -> while ( C ) { S }
@@ -78,6 +91,12 @@ struct Attribute
 {
     string place;       // 变量名、临时变量名或标号名AQ Qz
     vector<Quad> code;  // 该语法成分生成的中间代码序列
+
+    // 回填模式下使用 (四元式统一存放在 Parser 的全局序列中，以下均为其下标)
+    vector<int> trueList;  // 条件为真时需要回填的跳转四元式
+    vector<int> falseList; // 条件为假时需要回填的跳转四元式
+    vector<int> nextList;  // 语句执行完后需要回填的跳转四元式
+    int begin = -1;        // 该语法成分第一条四元式的下标，-1 表示未生成代码
 };
 
 /**
@@ -0,0 +1,30 @@
+#include "embedded.h"
+
+#ifdef SLR_CONSTEXPR_TABLES
+// 与 testfile.txt 的产生式相同 (%token / %skip 由运行时的词法分析器处理，这里省略)
+static constexpr char kEmbeddedGrammarText[] = R"(S' -> S
+S -> while ( C ) { S }
+S -> id = E
+C -> E > E
+C -> E < E
+C -> E == E
+E -> id + E
+E -> num + E
+E -> id
+E -> num
+)";
+
+// 分析表在编译期生成，若文法存在冲突则这里编译失败
+static constexpr auto kEmbeddedGrammar = SLR_EMBED_GRAMMAR(kEmbeddedGrammarText);
+#endif
+
+bool embeddedGrammar(EmbeddedTableView& view)
+{
+#ifdef SLR_CONSTEXPR_TABLES
+    view = kEmbeddedGrammar.view();
+    return true;
+#else
+    (void)view;
+    return false;
+#endif
+}
@@ -0,0 +1,441 @@
+#ifndef EMBEDDED_H
+#define EMBEDDED_H
+
+#include "common.h"
+#include <string_view>
+
+/**
+ * @brief 编译期生成的分析表的只读视图
+ * 所有数组都指向 static constexpr 对象，符号名指向文法文本 (字符串字面量) 本身，
+ * 运行时不需要任何构造工作，GrammarAnalyzer::loadEmbedded() 直接据此装入紧凑表
+ */
+struct EmbeddedTableView
+{
+    const string_view* terms;       // [列号] -> 终结符 (字典序，含 #)
+    int numTerms;
+    const string_view* nonTerms;    // [列号] -> 非终结符 (字典序)
+    int numNonTerms;
+    int numStates;
+    int numProds;
+    int startSymbol;                // 开始符号的非终结符下标
+    const int* prodLhs;             // [产生式] -> 左部的非终结符下标
+    const int* rhsBegin;            // 产生式 p 的右部为 rhs[rhsBegin[p], rhsBegin[p + 1])
+    const string_view* rhs;
+    const Action* action;           // [状态 * numTerms + 列号]，空表项为 {'e', 0}
+    const int* goTo;                // [状态 * numNonTerms + 列号]，空表项为 -1
+};
+
+#if __cplusplus >= 202002L
+#define SLR_CONSTEXPR_TABLES 1
+#endif
+
+#ifdef SLR_CONSTEXPR_TABLES
+#include <array>
+#include <algorithm>
+
+/*
+ * 编译期 SLR(1) 分析表构造 (需要 C++20: constexpr vector 与 consteval)
+ *
+ * 用法:
+ *   static constexpr char kText[] = "S' -> S\nS -> id = E\n...";
+ *   static constexpr auto kTable = SLR_EMBED_GRAMMAR(kText);
+ *   G.loadEmbedded(kTable.view());
+ *
+ * 文法文本的格式与 loadGrammar() 相同，%left / %right / %nonassoc 参与冲突消解，
+ * %token / %skip 行被忽略 (词法分析在运行时进行)。
+ * 构造过程与 GrammarAnalyzer::build() 逐步对应 (First/Follow -> LR(0) 项目集族 -> SLR(1) 表)，
+ * 符号按字典序遍历，因此状态编号和表项与运行时构造的结果完全相同。
+ *
+ * 先由 measureEmbeddedGrammar() 在编译期求出各数组的长度，再以此为模板参数构造定长数组，
+ * 中间数据 (项目集、First/Follow 集) 只存在于常量求值期间，不进入目标文件。
+ * 冲突或文法格式错误时调用下面的非 constexpr 函数，常量求值失败，编译报错信息中会出现函数名
+ */
+inline void embeddedShiftReduceConflict() {}
+inline void embeddedReduceReduceConflict() {}
+inline void embeddedGrammarSyntaxError() {}
+
+/**
+ * @brief 编译期分析表的各维大小，作为 EmbeddedTable 的模板参数
+ */
+struct EmbeddedDims
+{
+    int terms, nonTerms, prods, rhsSyms, states;
+};
+
+/**
+ * @brief 常量求值期间使用的构造器
+ * 符号编号: 终结符为 0..T-1，非终结符为 T..T+N-1，两者各自按字典序编号
+ */
+class EmbeddedBuilder
+{
+public:
+    vector<string_view> terms, nonTerms;
+    vector<int> prodLhs;                // [产生式] -> 非终结符下标
+    vector<vector<int>> prodRhs;        // [产生式] -> 符号编号序列
+    vector<int> precLevel;              // [符号] -> 优先级，-1 表示未声明
+    vector<char> precAssoc;             // [符号] -> 'l' / 'r' / 'n'
+    int start = 0;
+    int itemWidth = 1;                  // 项目编号 = 产生式 * itemWidth + 圆点位置
+    vector<vector<bool>> first, follow; // [非终结符][终结符]
+    vector<vector<int>> states;         // [状态] -> 按 (产生式, 圆点) 排序的项目编号
+    vector<vector<int>> trans;          // [状态][符号] -> 目标状态，-1 表示无转移
+    vector<Action> action;              // [状态 * T + 终结符]
+    vector<int> goTo;                   // [状态 * N + 非终结符]
+
+    constexpr EmbeddedBuilder(string_view text)
+    {
+        parse(text);
+        computeFirst();
+        computeFollow();
+        buildDFA();
+        buildTable();
+    }
+
+    constexpr int numSymbols() const { return terms.size() + nonTerms.size(); }
+    constexpr bool isTerm(int sym) const { return sym < (int)terms.size(); }
+    constexpr string_view name(int sym) const { return isTerm(sym) ? terms[sym] : nonTerms[sym - terms.size()]; }
+
+private:
+    static constexpr bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static constexpr int indexOf(const vector<string_view>& v, string_view s)
+    {
+        auto it = lower_bound(v.begin(), v.end(), s);
+        return (it != v.end() && *it == s) ? it - v.begin() : -1;
+    }
+
+    static constexpr void sortUnique(vector<string_view>& v)
+    {
+        sort(v.begin(), v.end());
+        v.erase(unique(v.begin(), v.end()), v.end());
+    }
+
+    // 读入产生式和优先级声明，规则与 GrammarAnalyzer::loadGrammar() 相同
+    constexpr void parse(string_view text)
+    {
+        vector<string_view> lhsNames;
+        vector<vector<string_view>> rhsNames;
+        vector<pair<string_view, pair<int, char>>> precDecl;
+        int level = 0;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t eol = text.find('\n', pos);
+            if (eol == string_view::npos) eol = text.size();
+            vector<string_view> words;
+            for (size_t i = pos; i < eol;)
+            {
+                while (i < eol && isSpace(text[i])) ++i;
+                size_t j = i;
+                while (j < eol && !isSpace(text[j])) ++j;
+                if (j > i) words.push_back(text.substr(i, j - i));
+                i = j;
+            }
+            pos = eol + 1;
+            if (words.empty()) continue;
+
+            if (words[0][0] == '%')
+            {
+                char assoc = words[0] == "%left" ? 'l' : words[0] == "%right" ? 'r' : words[0] == "%nonassoc" ? 'n' : 0;
+                if (assoc == 0) continue;
+                level++;
+                for (size_t i = 1; i < words.size(); ++i) precDecl.push_back({words[i], {level, assoc}});
+                continue;
+            }
+            if (words.size() < 2 || words[1] != "->") embeddedGrammarSyntaxError();
+            lhsNames.push_back(words[0]);
+            rhsNames.push_back(vector<string_view>(words.begin() + 2, words.end()));
+        }
+        if (lhsNames.empty()) embeddedGrammarSyntaxError();
+
+        // 左部出现过的为非终结符，其余为终结符，另加结束符 #
+        nonTerms = lhsNames;
+        sortUnique(nonTerms);
+        terms.push_back("#");
+        for (const auto& rhs : rhsNames)
+        {
+            for (const auto& sym : rhs)
+                if (indexOf(nonTerms, sym) < 0) terms.push_back(sym);
+        }
+        sortUnique(terms);
+
+        auto symbolOf = [&](string_view s) -> int {
+            int t = indexOf(terms, s);
+            return t >= 0 ? t : (int)terms.size() + indexOf(nonTerms, s);
+        };
+        start = indexOf(nonTerms, lhsNames[0]);
+        for (size_t p = 0; p < lhsNames.size(); ++p)
+        {
+            prodLhs.push_back(indexOf(nonTerms, lhsNames[p]));
+            vector<int> rhs;
+            for (const auto& sym : rhsNames[p]) rhs.push_back(symbolOf(sym));
+            prodRhs.push_back(rhs);
+            itemWidth = max(itemWidth, (int)rhs.size() + 1);
+        }
+
+        precLevel.assign(numSymbols(), -1);
+        precAssoc.assign(numSymbols(), 0);
+        for (const auto& d : precDecl)
+        {
+            int t = indexOf(terms, d.first);
+            int sym = t >= 0 ? t : (indexOf(nonTerms, d.first) >= 0 ? symbolOf(d.first) : -1);
+            if (sym < 0) continue;
+            precLevel[sym] = d.second.first;
+            precAssoc[sym] = d.second.second;
+        }
+    }
+
+    constexpr void computeFirst()
+    {
+        first.assign(nonTerms.size(), vector<bool>(terms.size(), false));
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t p = 0; p < prodRhs.size(); ++p)
+            {
+                if (prodRhs[p].empty()) continue;
+                int X = prodLhs[p], Y = prodRhs[p][0];
+                for (size_t a = 0; a < terms.size(); ++a)
+                {
+                    bool in = isTerm(Y) ? (int)a == Y : first[Y - terms.size()][a];
+                    if (in && !first[X][a]) first[X][a] = changed = true;
+                }
+            }
+        }
+    }
+
+    constexpr void computeFollow()
+    {
+        follow.assign(nonTerms.size(), vector<bool>(terms.size(), false));
+        follow[start][indexOf(terms, "#")] = true;
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t p = 0; p < prodRhs.size(); ++p)
+            {
+                const vector<int>& rhs = prodRhs[p];
+                for (size_t i = 0; i < rhs.size(); ++i)
+                {
+                    if (isTerm(rhs[i])) continue;
+                    int B = rhs[i] - terms.size();
+                    for (size_t a = 0; a < terms.size(); ++a)
+                    {
+                        bool in;
+                        if (i + 1 < rhs.size())
+                            in = isTerm(rhs[i + 1]) ? (int)a == rhs[i + 1] : first[rhs[i + 1] - terms.size()][a];
+                        else
+                            in = follow[prodLhs[p]][a];
+                        if (in && !follow[B][a]) follow[B][a] = changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // 项目集闭包，返回按编号排序的项目
+    constexpr vector<int> closure(const vector<int>& kernel) const
+    {
+        vector<bool> in(prodRhs.size() * itemWidth, false);
+        vector<int> work = kernel;
+        for (int item : kernel) in[item] = true;
+        for (size_t i = 0; i < work.size(); ++i)
+        {
+            int p = work[i] / itemWidth, dot = work[i] % itemWidth;
+            if (dot >= (int)prodRhs[p].size() || isTerm(prodRhs[p][dot])) continue;
+            int B = prodRhs[p][dot] - terms.size();
+            for (size_t q = 0; q < prodRhs.size(); ++q)
+            {
+                int item = q * itemWidth;
+                if (prodLhs[q] == B && !in[item])
+                {
+                    in[item] = true;
+                    work.push_back(item);
+                }
+            }
+        }
+        vector<int> result;
+        for (size_t item = 0; item < in.size(); ++item)
+            if (in[item]) result.push_back(item);
+        return result;
+    }
+
+    // LR(0) 项目集族: 与 buildDFA() 一样按广度优先编号，每个状态按符号名的字典序计算转移
+    constexpr void buildDFA()
+    {
+        vector<int> byName(numSymbols());
+        for (int i = 0; i < numSymbols(); ++i) byName[i] = i;
+        sort(byName.begin(), byName.end(), [&](int x, int y) { return name(x) < name(y); });
+
+        states.push_back(closure({0}));
+        for (size_t s = 0; s < states.size(); ++s)
+        {
+            trans.push_back(vector<int>(numSymbols(), -1));
+            for (int X : byName)
+            {
+                vector<int> kernel;
+                for (int item : states[s])
+                {
+                    int p = item / itemWidth, dot = item % itemWidth;
+                    if (dot < (int)prodRhs[p].size() && prodRhs[p][dot] == X) kernel.push_back(item + 1);
+                }
+                if (kernel.empty()) continue;
+                vector<int> next = closure(kernel);
+                size_t target = 0;
+                while (target < states.size() && states[target] != next) ++target;
+                if (target == states.size()) states.push_back(next);
+                trans[s][X] = target;
+            }
+        }
+    }
+
+    // 产生式优先级: 右部最后一个声明了优先级的符号
+    constexpr int productionPrecedence(int p) const
+    {
+        for (int i = (int)prodRhs[p].size() - 1; i >= 0; --i)
+            if (precLevel[prodRhs[p][i]] >= 0) return precLevel[prodRhs[p][i]];
+        return -1;
+    }
+
+    constexpr char resolveShiftReduce(int p, int a) const
+    {
+        int prodPrec = productionPrecedence(p);
+        if (prodPrec < 0 || precLevel[a] < 0) return 0;
+        if (prodPrec > precLevel[a]) return 'r';
+        if (prodPrec < precLevel[a]) return 's';
+        if (precAssoc[a] == 'l') return 'r';
+        if (precAssoc[a] == 'r') return 's';
+        return 'e';
+    }
+
+    // SLR(1) 表，冲突的处理与 buildSLRTable() 相同
+    constexpr void buildTable()
+    {
+        int T = terms.size(), N = nonTerms.size();
+        action.assign(states.size() * T, {'e', 0});
+        goTo.assign(states.size() * N, -1);
+        vector<bool> filled(states.size() * T, false); // 区分空表项与 %nonassoc 置的错误表项
+        for (size_t s = 0; s < states.size(); ++s)
+        {
+            for (int X = 0; X < numSymbols(); ++X)
+            {
+                if (trans[s][X] < 0) continue;
+                if (isTerm(X))
+                {
+                    action[s * T + X] = {'s', trans[s][X]};
+                    filled[s * T + X] = true;
+                }
+                else
+                    goTo[s * N + X - T] = trans[s][X];
+            }
+            for (int item : states[s])
+            {
+                int p = item / itemWidth, dot = item % itemWidth;
+                if (dot < (int)prodRhs[p].size()) continue;
+                if (prodLhs[p] == start)
+                {
+                    int end = indexOf(terms, "#");
+                    action[s * T + end] = {'a', 0};
+                    filled[s * T + end] = true;
+                    continue;
+                }
+                for (int a = 0; a < T; ++a)
+                {
+                    if (!follow[prodLhs[p]][a]) continue;
+                    Action& entry = action[s * T + a];
+                    if (filled[s * T + a])
+                    {
+                        if (entry.type == 's')
+                        {
+                            char how = resolveShiftReduce(p, a);
+                            if (how == 0) embeddedShiftReduceConflict();
+                            if (how == 's') continue;
+                            if (how == 'e')
+                            {
+                                entry = {'e', 0};
+                                continue;
+                            }
+                        }
+                        else if (entry.type == 'e')
+                            continue;
+                        else if (entry.type == 'r' && entry.val != p)
+                            embeddedReduceReduceConflict();
+                    }
+                    entry = {'r', p};
+                    filled[s * T + a] = true;
+                }
+            }
+        }
+    }
+};
+
+/**
+ * @brief 编译期生成的分析表，数组长度由 EmbeddedDims 给出
+ */
+template <EmbeddedDims D>
+struct EmbeddedTable
+{
+    array<string_view, D.terms> terms{};
+    array<string_view, D.nonTerms> nonTerms{};
+    array<int, D.prods> prodLhs{};
+    array<int, D.prods + 1> rhsBegin{};
+    array<string_view, D.rhsSyms> rhs{};
+    array<Action, D.states * D.terms> action{};
+    array<int, D.states * D.nonTerms> goTo{};
+    int startSymbol = 0;
+
+    constexpr EmbeddedTableView view() const
+    {
+        return {terms.data(), D.terms, nonTerms.data(), D.nonTerms, D.states, D.prods, startSymbol,
+                prodLhs.data(), rhsBegin.data(), rhs.data(), action.data(), goTo.data()};
+    }
+};
+
+/**
+ * @brief 第一遍: 求出分析表的各维大小
+ */
+consteval EmbeddedDims measureEmbeddedGrammar(string_view text)
+{
+    EmbeddedBuilder b(text);
+    int rhsSyms = 0;
+    for (const auto& rhs : b.prodRhs) rhsSyms += rhs.size();
+    return {(int)b.terms.size(), (int)b.nonTerms.size(), (int)b.prodRhs.size(), rhsSyms, (int)b.states.size()};
+}
+
+/**
+ * @brief 第二遍: 把构造结果复制到定长数组
+ */
+template <EmbeddedDims D>
+consteval EmbeddedTable<D> buildEmbeddedTable(string_view text)
+{
+    EmbeddedBuilder b(text);
+    EmbeddedTable<D> t;
+    copy(b.terms.begin(), b.terms.end(), t.terms.begin());
+    copy(b.nonTerms.begin(), b.nonTerms.end(), t.nonTerms.begin());
+    int k = 0;
+    for (int p = 0; p < D.prods; ++p)
+    {
+        t.prodLhs[p] = b.prodLhs[p];
+        t.rhsBegin[p] = k;
+        for (int sym : b.prodRhs[p]) t.rhs[k++] = b.name(sym);
+    }
+    t.rhsBegin[D.prods] = k;
+    copy(b.action.begin(), b.action.end(), t.action.begin());
+    copy(b.goTo.begin(), b.goTo.end(), t.goTo.begin());
+    t.startSymbol = b.start;
+    return t;
+}
+
+// 由文法文本 (字符串字面量或 constexpr 字符数组) 在编译期生成 EmbeddedTable
+#define SLR_EMBED_GRAMMAR(text) buildEmbeddedTable<measureEmbeddedGrammar(text)>(text)
+
+#endif
+
+/**
+ * @brief 取内置文法 (与 testfile.txt 的产生式相同) 的编译期分析表
+ * @return 以 C++20 之前的标准编译时没有编译期分析表，返回 false
+ */
+bool embeddedGrammar(EmbeddedTableView& view);
+
+#endif
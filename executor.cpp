@@ -0,0 +1,200 @@
+#include "executor.h"
+#include <cctype>
+
+int LoweredProgram::slotOf(const string& name) const
+{
+    auto it = slots.find(name);
+    return it == slots.end() ? -1 : it->second;
+}
+
+// 把关系运算符字符串转换为 RelOp
+static bool parseRelOp(const string& s, RelOp& rel)
+{
+    if (s == ">") rel = REL_GT;
+    else if (s == "<") rel = REL_LT;
+    else if (s == "==") rel = REL_EQ;
+    else if (s == ">=") rel = REL_GE;
+    else if (s == "<=") rel = REL_LE;
+    else if (s == "!=") rel = REL_NE;
+    else return false;
+    return true;
+}
+
+// 判断一个操作数是否为数字常量 (可带正负号)
+static bool isNumber(const string& s)
+{
+    size_t i = (s.size() > 1 && (s[0] == '+' || s[0] == '-')) ? 1 : 0;
+    if (i >= s.size()) return false;
+    for (; i < s.size(); ++i)
+    {
+        if (!isdigit((unsigned char)s[i]) && s[i] != '.') return false;
+    }
+    return true;
+}
+
+bool lowerQuads(const vector<Quad>& quads, LoweredProgram& prog, string& err)
+{
+    prog = LoweredProgram();
+    int n = quads.size();
+
+    // 1. 记录标号所在的四元式下标
+    map<string, int> labelPos;
+    for (int i = 0; i < n; ++i)
+    {
+        if (quads[i].op == "label") labelPos[quads[i].result] = i;
+    }
+
+    auto slotFor = [&](const string& name) -> int {
+        auto it = prog.slots.find(name);
+        if (it != prog.slots.end()) return it->second;
+        int id = prog.slotNames.size();
+        prog.slots[name] = id;
+        prog.slotNames.push_back(name);
+        return id;
+    };
+    auto operand = [&](const string& s, Operand& o) -> bool {
+        o = {false, 0, -1};
+        if (isNumber(s))
+        {
+            if (s.find('.') != string::npos)
+            {
+                err = "不支持小数常量 " + s;
+                return false;
+            }
+            o.isImm = true;
+            o.imm = stoll(s);
+        }
+        else
+        {
+            o.slot = slotFor(s);
+        }
+        return true;
+    };
+    // 跳转目标: 标号名或从 1 开始的四元式序号 (超出范围视为程序末尾，序号 0 不合法)
+    auto target = [&](const string& s, int& t) -> bool {
+        if (labelPos.count(s)) t = labelPos[s];
+        else if (!s.empty() && s.find_first_not_of("0123456789") == string::npos)
+        {
+            long long index = s.size() > 18 ? (long long)n + 1 : stoll(s);
+            if (index < 1)
+            {
+                err = "跳转目标序号越界 " + s;
+                return false;
+            }
+            t = (int)min<long long>(index - 1, n);
+        }
+        else
+        {
+            err = "无法解析的跳转目标 " + s;
+            return false;
+        }
+        return true;
+    };
+
+    // 2. 逐条翻译，指令与四元式一一对应，因此跳转目标下标不变
+    for (const auto& q : quads)
+    {
+        Instr in = {OP_NOP, REL_GT, {false, 0, -1}, {false, 0, -1}, -1, -1};
+        bool ok = true;
+        if (q.op == "label")
+        {
+            in.op = OP_NOP;
+        }
+        else if (q.op == "=")
+        {
+            in.op = OP_MOV;
+            ok = operand(q.arg1, in.a);
+            in.dst = slotFor(q.result);
+        }
+        else if (q.op == "+" || q.op == "-" || q.op == "*")
+        {
+            in.op = q.op == "+" ? OP_ADD : (q.op == "-" ? OP_SUB : OP_MUL);
+            ok = operand(q.arg1, in.a) && operand(q.arg2, in.b);
+            in.dst = slotFor(q.result);
+        }
+        else if (parseRelOp(q.op, in.rel))
+        {
+            in.op = OP_CMP;
+            ok = operand(q.arg1, in.a) && operand(q.arg2, in.b);
+            in.dst = slotFor(q.result);
+        }
+        else if (q.op == "jfalse" || q.op == "jtrue")
+        {
+            in.op = q.op == "jfalse" ? OP_JFALSE : OP_JTRUE;
+            ok = operand(q.arg1, in.a) && target(q.result, in.target);
+        }
+        else if (q.op == "jump" || q.op == "j")
+        {
+            in.op = OP_JUMP;
+            ok = target(q.result, in.target);
+        }
+        else if (q.op.size() > 1 && q.op[0] == 'j' && parseRelOp(q.op.substr(1), in.rel))
+        {
+            in.op = OP_JCMP;
+            ok = operand(q.arg1, in.a) && operand(q.arg2, in.b) && target(q.result, in.target);
+        }
+        else
+        {
+            err = "不支持的四元式 " + q.toString();
+            return false;
+        }
+        if (!ok) return false;
+        prog.code.push_back(in);
+    }
+    return true;
+}
+
+Interpreter::Interpreter(const LoweredProgram& program) : prog(program) {}
+
+// 计算关系运算
+static inline bool compare(RelOp rel, long long a, long long b)
+{
+    switch (rel)
+    {
+        case REL_GT: return a > b;
+        case REL_LT: return a < b;
+        case REL_EQ: return a == b;
+        case REL_GE: return a >= b;
+        case REL_LE: return a <= b;
+        default:     return a != b;
+    }
+}
+
+long long Interpreter::run(vector<long long>& env, vector<long long>* opCounts)
+{
+    const vector<Instr>& code = prog.code;
+    int n = code.size();
+    long long* v = env.data();
+    long long executed = 0;
+    long long* counts = nullptr;
+    if (opCounts)
+    {
+        opCounts->assign(OP_JCMP + 1, 0);
+        counts = opCounts->data();
+    }
+
+    int pc = 0;
+    while (pc < n)
+    {
+        const Instr& in = code[pc];
+        long long a = in.a.isImm ? in.a.imm : (in.a.slot >= 0 ? v[in.a.slot] : 0);
+        long long b = in.b.isImm ? in.b.imm : (in.b.slot >= 0 ? v[in.b.slot] : 0);
+        executed++;
+        if (counts) counts[in.op]++;
+        pc++;
+        switch (in.op)
+        {
+            case OP_NOP:    break;
+            case OP_MOV:    v[in.dst] = a; break;
+            case OP_ADD:    v[in.dst] = a + b; break;
+            case OP_SUB:    v[in.dst] = a - b; break;
+            case OP_MUL:    v[in.dst] = a * b; break;
+            case OP_CMP:    v[in.dst] = compare(in.rel, a, b) ? 1 : 0; break;
+            case OP_JFALSE: if (a == 0) pc = in.target; break;
+            case OP_JTRUE:  if (a != 0) pc = in.target; break;
+            case OP_JUMP:   pc = in.target; break;
+            case OP_JCMP:   if (compare(in.rel, a, b)) pc = in.target; break;
+        }
+    }
+    return executed;
+}
@@ -0,0 +1,97 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "common.h"
+
+/**
+ * @brief 低级指令的操作码
+ * 由四元式翻译而来，标号已解析为指令下标，变量已映射为槽位
+ */
+enum OpCode
+{
+    OP_NOP,    // label 四元式，执行时什么也不做
+    OP_MOV,    // dst = a
+    OP_ADD,    // dst = a + b
+    OP_SUB,    // dst = a - b
+    OP_MUL,    // dst = a * b
+    OP_CMP,    // dst = (a relop b) ? 1 : 0
+    OP_JFALSE, // if a == 0 goto target
+    OP_JTRUE,  // if a != 0 goto target  (循环倒置后位于循环底部的条件跳转)
+    OP_JUMP,   // goto target
+    OP_JCMP    // if (a relop b) goto target  (回填模式的 j>, j< ...)
+};
+
+/**
+ * @brief 关系运算符
+ */
+enum RelOp { REL_GT, REL_LT, REL_EQ, REL_GE, REL_LE, REL_NE };
+
+/**
+ * @brief 指令操作数: 立即数或变量槽位
+ */
+struct Operand
+{
+    bool isImm;     // 是否为立即数
+    long long imm;  // 立即数的值
+    int slot;       // 变量槽位 (isImm 为 false 时有效)
+};
+
+/**
+ * @brief 低级指令
+ */
+struct Instr
+{
+    OpCode op;
+    RelOp rel;     // OP_CMP / OP_JCMP 使用的关系运算
+    Operand a, b;  // 源操作数
+    int dst;       // 目标变量槽位
+    int target;    // 跳转目标的指令下标 (等于指令条数表示跳到程序末尾)
+};
+
+/**
+ * @brief 翻译后的可执行程序
+ * 变量 (包括临时变量) 统一映射为 64 位整数槽位，运行时环境即一个 long long 数组
+ */
+struct LoweredProgram
+{
+    vector<Instr> code;         // 指令序列
+    vector<string> slotNames;   // 槽位 -> 变量名
+    map<string, int> slots;     // 变量名 -> 槽位
+
+    /**
+     * @brief 查询变量的槽位
+     * @return 槽位编号，变量不存在时返回 -1
+     */
+    int slotOf(const string& name) const;
+};
+
+/**
+ * @brief 把四元式序列翻译为低级指令
+ * 支持 =, +, -, *, >, <, ==, label, jfalse, jtrue, jump 以及回填模式的 j, j>, j<, j==
+ * 常量仅支持整数
+ * @param err 失败时写入错误原因
+ * @return 成功返回 true
+ */
+bool lowerQuads(const vector<Quad>& quads, LoweredProgram& prog, string& err);
+
+/**
+ * @brief 字节码解释器
+ * 作为本地代码后端的基准，对低级指令逐条 switch 分派执行
+ */
+class Interpreter
+{
+    const LoweredProgram& prog;
+
+public:
+    Interpreter(const LoweredProgram& program);
+
+    /**
+     * @brief 执行程序
+     * @param env 变量环境，大小不小于槽位个数
+     * @param opCounts 不为空时按操作码累计执行次数 (下标为 OpCode)
+     * @return 执行的指令条数
+     */
+    long long run(vector<long long>& env, vector<long long>* opCounts = nullptr);
+};
+
+#endif
@@ -8,20 +8,88 @@ bool GrammarAnalyzer::isTerminal(const string& s) {
     return terminals.count(s);
 }
 
+int GrammarAnalyzer::productionPrecedence(const Production& prod) 
+{
+    for (int i = (int)prod.rhs.size() - 1; i >= 0; --i) 
+    {
+        auto it = precedence.find(prod.rhs[i]);
+        if (it != precedence.end()) return it->second.first;
+    }
+    return -1;
+}
+
+/**
+ * @brief 按 yacc 的规则消解移进-归约冲突
+ * 1. 产生式或终结符未声明优先级，无法消解
+ * 2. 产生式优先级高则归约，终结符优先级高则移进
+ * 3. 优先级相同时: %left 归约，%right 移进，%nonassoc 报错
+ */
+char GrammarAnalyzer::resolveShiftReduce(const Production& prod, const string& a) 
+{
+    int prodPrec = productionPrecedence(prod);
+    auto it = precedence.find(a);
+    if (prodPrec < 0 || it == precedence.end()) return 0;
+
+    int tokenPrec = it->second.first;
+    if (prodPrec > tokenPrec) return 'r';
+    if (prodPrec < tokenPrec) return 's';
+    if (it->second.second == 'l') return 'r';
+    if (it->second.second == 'r') return 's';
+    return 'e';
+}
+
 /**
  * @brief 加载文法文件
  * 文件格式: LHS -> RHS (符号间用空格分隔)
  * 例如: S -> while ( C ) { S }
+ * 优先级声明: %left + -  /  %right =  /  %nonassoc ==
+ * 词法定义: %token num [0-9]+  /  %skip [ \t\r\n]+
  */
 void GrammarAnalyzer::loadGrammar(const string& filename) {
     ifstream file(filename);
+    loadGrammar(file);
+}
+
+void GrammarAnalyzer::loadGrammar(istream& file) {
     string line;
     int id = 0;
+    int level = 0; // 当前优先级声明的级别
     while (getline(file, line)) 
     {
         if (line.empty()) continue;
         stringstream ss(line);
         string lhs, arrow, sym;
+
+        // 优先级与结合性声明行、词法定义行
+        if (line[0] == '%') 
+        {
+            string decl;
+            ss >> decl;
+            if (decl == "%token" || decl == "%skip") 
+            {
+                // 正则表达式取行的剩余部分，允许其中包含空格
+                string name, pattern;
+                if (decl == "%token") ss >> name;
+                getline(ss >> ws, pattern);
+                while (!pattern.empty() && (pattern.back() == '\r' || pattern.back() == ' ')) pattern.pop_back();
+                tokenDefs.push_back({name, pattern, false, decl == "%skip"});
+                continue;
+            }
+            char assoc = 0;
+            if (decl == "%left") assoc = 'l';
+            else if (decl == "%right") assoc = 'r';
+            else if (decl == "%nonassoc") assoc = 'n';
+            if (assoc == 0) 
+            {
+                cout << "未知的声明: " << decl << endl;
+                continue;
+            }
+            level++;
+            while (ss >> sym) 
+                precedence[sym] = {level, assoc};
+            continue;
+        }
+
         //lhs -- 产生式左部  arrow -- 箭头  sym -- 产生式右部
         ss >> lhs >> arrow; // 读取左部和箭头
         
@@ -52,6 +120,33 @@ void GrammarAnalyzer::loadGrammar(const string& filename) {
         }
     }
     terminals.insert("#"); // 显式添加结束符
+
+    // 生成词法分析表: 字面量终结符在前 (关键字优先于标识符)，然后是 %token 定义，最后是跳过的模式
+    if (tokenDefs.empty()) return;
+    set<string> named;
+    bool hasSkip = false;
+    for (const auto& d : tokenDefs) 
+    {
+        if (d.skip) hasSkip = true;
+        else named.insert(d.name);
+    }
+    vector<TokenDef> defs;
+    for (const auto& t : terminals) 
+    {
+        if (t != "#" && !named.count(t)) defs.push_back({t, t, true, false});
+    }
+    for (const auto& d : tokenDefs) 
+    {
+        if (!d.skip) defs.push_back(d);
+    }
+    for (const auto& d : tokenDefs) 
+    {
+        if (d.skip) defs.push_back(d);
+    }
+    if (!hasSkip) defs.push_back({"", "[ \\t\\r\\n]+", false, true}); // 默认跳过空白
+    string err;
+    if (!buildLexTable(defs, lexTable, err)) 
+        cout << "词法定义错误: " << err << "，改用手写的词法分析器" << endl;
 }
 
 /**
@@ -172,69 +267,64 @@ void GrammarAnalyzer::computeFollow()
 }
 
 /**
- * @brief 计算项目集闭包 Closure(I)
- * 规则:
- * 若 A -> alpha . B beta 在 I 中，则将所有 B -> . gamma 加入 I
+ * @brief 为符号编号: 终结符与非终结符统一按名字的字典序编号，
+ * 同时把产生式右部转换为符号编号，并按左部归类产生式
  */
-set<Item> GrammarAnalyzer::closure(set<Item> I) 
+void GrammarAnalyzer::indexSymbols() 
 {
-    bool changed = true;
-    while (changed)
+    set<string> all = terminals;
+    all.insert(nonTerminals.begin(), nonTerminals.end());
+    symbols.assign(all.begin(), all.end());
+    symbolId.clear();
+    symbolIsTerminal.clear();
+    for (int i = 0; i < (int)symbols.size(); ++i) 
     {
-        changed = false;
-        set<Item> newItems = I;
-        for (const auto& item : I) 
-        {
-            // 检查圆点后面是否有符号
-            if (item.dotPos < grammar[item.prodIndex].rhs.size()) 
-            {
-                //获取圆点后符号（终结符或者非终结符）
-                string B = grammar[item.prodIndex].rhs[item.dotPos];
-                // 如果圆点后是非终结符，展开它
-                if (nonTerminals.count(B)) 
-                {
-                    for (const auto& prod : grammar) 
-                    {
-                        //找到该非终结符的产生式，展开它并加入到newItems中
-                        if (prod.lhs == B) 
-                        {
-                            Item newItem = {prod.id, 0}; // 圆点在开头
-                            //去重
-                            if (newItems.find(newItem) == newItems.end()) 
-                            {
-                                newItems.insert(newItem);
-                                //添加了新项目集，需要再重新遍历一次
-                                changed = true;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        I = newItems;
+        symbolId[symbols[i]] = i;
+        symbolIsTerminal.push_back(isTerminal(symbols[i]));
+    }
+    rhsSymbols.clear();
+    prodsOf.assign(symbols.size(), vector<int>());
+    hasEmptyProduction = false;
+    for (const auto& prod : grammar) 
+    {
+        vector<int> rhs;
+        for (const auto& sym : prod.rhs) rhs.push_back(symbolId[sym]);
+        rhsSymbols.push_back(rhs);
+        prodsOf[symbolId[prod.lhs]].push_back(prod.id);
+        if (prod.rhs.empty()) hasEmptyProduction = true;
     }
-    return I;
 }
 
 /**
- * @brief 计算状态转移 Goto(I, X)
+ * @brief 计算项目集闭包 Closure(I)
  * 规则:
- * 将 I 中所有圆点后是 X 的项目，圆点后移一位，构成新集合 J，返回 Closure(J)
+ * 若 A -> alpha . B beta 在 I 中，则将所有 B -> . gamma 加入 I
+ * 每个非终结符只展开一次，结果为核心项目在前、新加入的项目在后 (未排序)
  */
-set<Item> GrammarAnalyzer::gotoState(const set<Item>& I, const string& X) 
+vector<Item> GrammarAnalyzer::closure(const vector<Item>& kernel) 
 {
-    set<Item> J;
-    for (const auto& item : I) 
+    vector<Item> I = kernel;
+    vector<char> expanded(symbols.size(), 0);
+    bool dotZero = false; // 核心中含圆点在最左边的项目 (只有初始状态)，展开时可能重复
+    for (const auto& item : kernel) 
+        dotZero = dotZero || item.dotPos == 0;
+    for (size_t k = 0; k < I.size(); ++k) 
     {
-        if (item.dotPos < grammar[item.prodIndex].rhs.size()) 
-        {
-            if (grammar[item.prodIndex].rhs[item.dotPos] == X) 
-            {
-                J.insert({item.prodIndex, item.dotPos + 1});
-            }
-        }
+        const vector<int>& rhs = rhsSymbols[I[k].prodIndex];
+        // 检查圆点后面是否有符号，且为尚未展开的非终结符
+        if (I[k].dotPos >= (int)rhs.size()) continue;
+        int B = rhs[I[k].dotPos];
+        if (symbolIsTerminal[B] || expanded[B]) continue;
+        expanded[B] = 1;
+        for (int p : prodsOf[B]) 
+            I.push_back({p, 0}); // 圆点在开头
+    }
+    if (dotZero) 
+    {
+        sort(I.begin(), I.end());
+        I.erase(unique(I.begin(), I.end()), I.end());
     }
-    return closure(J);
+    return I;
 }
 
 /**
@@ -244,60 +334,161 @@ set<Item> GrammarAnalyzer::gotoState(const set<Item>& I, const string& X)
 void GrammarAnalyzer::buildDFA() 
 {
     // 1. 初始状态: S' -> . S 的闭包
-    Item startItem = {0, 0};//第一个0表示该状态在文法中属于第0个产生式，第二个0表示当前圆点的位置位于最开始处
-    set<Item> startSet;
-    startSet.insert(startItem);
-    startSet = closure(startSet);
-    
-    states.push_back({0, startSet});//存入第一个状态I0，第一个0表示状态集的编号，第二个表示存入状态集的项目集合
+    addStartState();
     
-    int processed = 0;
     //循环遍历直至无新状态集，判断条件即为Processed == states.size
-    while (processed < states.size()) 
+    for (int processed = 0; processed < states.size(); ++processed) 
+        expandState(processed);
+}
+
+void GrammarAnalyzer::addStartState() 
+{
+    states = StateStore();
+    Item startItem = {0, 0};//第一个0表示该状态在文法中属于第0个产生式，第二个0表示当前圆点的位置位于最开始处
+    states.add({startItem});//存入第一个状态I0，状态只保存核心项目，闭包在需要时再求
+}
+
+/**
+ * @brief 计算状态 processed 在每个符号上的转移 Goto(I, X)，目标项目集不存在时作为新状态加入 states
+ * 规则:
+ * 将 I 中所有圆点后是 X 的项目，圆点后移一位，构成新集合 J (即目标状态的核心项目)
+ * 一次扫描闭包得到 (X, 后移后的项目) 对，按 X 排序后每一段就是一个目标状态的核心
+ */
+void GrammarAnalyzer::expandState(int processed) 
+{
+    StateView S = states[processed];
+    vector<Item> I = closure(vector<Item>(S.kernel.begin(), S.kernel.end()));
+
+    vector<pair<int, Item>> moves;
+    for (const auto& item : I) 
+    {
+        //当前项目集中圆点不在最后，记录圆点后的符号和后移后的项目
+        const vector<int>& rhs = rhsSymbols[item.prodIndex];
+        if (item.dotPos < (int)rhs.size()) 
+            moves.push_back({rhs[item.dotPos], {item.prodIndex, item.dotPos + 1}});
+    }
+    sort(moves.begin(), moves.end());
+
+    // 符号编号即字典序，状态的编号顺序与按符号名遍历时相同
+    vector<Transition> trans;
+    vector<Item> kernel;
+    for (size_t i = 0; i < moves.size();) 
     {
-        // 收集当前状态所有可能的下一个输入符号
-        set<string> nextSymbols;
-        for (const auto& item : states[processed].items) 
+        int X = moves[i].first;
+        kernel.clear();
+        for (; i < moves.size() && moves[i].first == X; ++i) 
+            kernel.push_back(moves[i].second);
+
+        // 检查该状态集是否已存在，不存在则添加新状态
+        int target = states.find(kernel);
+        if (target < 0) 
+            target = states.add(kernel);
+        trans.push_back({X, target});
+    }
+    // 记录转移关系 I0--X-->I1
+    states.setTransitions(processed, trans);
+}
+
+/**
+ * @brief 填写状态 i 的 Action/Goto 行 (状态 i 的转移必须已经求出)
+ * @param resolvedConflicts 累计用优先级消解的移进-归约冲突个数
+ * @return 存在无法消解的冲突时返回 false
+ */
+bool GrammarAnalyzer::fillRow(int i, int& resolvedConflicts) 
+{
+    StateView S = states[i];
+    
+    // 1. 处理 Shift 动作 (移进) 和 GOTO表
+    // 根据状态转移数组: 输入符号编号 -> 目标状态ID
+    // 若有转移 state[i] --a--> state[j] 且 a 是终结符，则 Action[i][a] = sj
+    for (const auto& trans : S.transitions) 
+    {
+        const string& symbol = symbols[trans.symbol];//转移的符号
+        int target = trans.target;//下一个状态ID
+        // 如果是终结符 填入ACTION表中
+        if (isTerminal(symbol)) 
         {
-            //当前项目集中圆点不在最后，将所有圆点后的符号添加到nextSymbols集中
-            if (item.dotPos < grammar[item.prodIndex].rhs.size()) 
+            if (actionTable[i].count(symbol)) 
             {
-                nextSymbols.insert(grammar[item.prodIndex].rhs[item.dotPos]);
+                //如果ACTION表中在同一行存在关于终结符symbol的动作(移进/规约)，说明存在移进规约冲突，直接返回false
+                cout << "错误：存在移进规约冲突，位于状态 " << i << " 符号 " << symbol << endl;
+                return false;
             }
-        }
-        
-        // 对每个符号计算 Goto
-        for (const auto& X : nextSymbols) 
+            //移进{s,target}.s表示移进，target是下一个状态
+            actionTable[i][symbol] = {'s', target};
+        } 
+        else 
         {
-            //对于下一个输入符号，通过GotoState函数获取经过该输入符号的下一个状态集
-            set<Item> nextItemSet = gotoState(states[processed].items, X);
-            if (nextItemSet.empty()) continue;
-            
-            // 检查该状态集是否已存在
-            int existingStateId = -1;
-            for (int i = 0; i < states.size(); ++i) 
+            // 若 a 是非终结符E或者T等等填入GOTO表，则 Goto[i][a] = j 表示状态转移
+            // GOTO target下一个状态
+            gotoTable[i][symbol] = target;
+        }
+    }
+    
+    // 2. 处理 Reduce 动作 (归约)
+    // 只有圆点在最后时候才能规约
+    // 若项目 A -> alpha . 属于 state[i]，则对 Follow(A) 中的每个符号 a 都进行规约对应产生式的ID，Action[i][a] = r(prod_id)
+
+    // 遍历当前状态下的所有项目，因为可能不止一个项目
+    // 圆点在最后的项目都是核心项目，只有存在空产生式时才需要求闭包
+    vector<Item> items(S.kernel.begin(), S.kernel.end());
+    if (hasEmptyProduction) 
+        items = closure(items);
+    for (const auto& item : items) 
+    {
+        if (item.dotPos == (int)grammar[item.prodIndex].rhs.size()) 
+        { // 圆点在最后
+            // 如果项目对应的产生式是第一个产生式的话呢，就直接ACC接受，填入{'a',0}
+            if (grammar[item.prodIndex].lhs == startSymbol) //接受
+            {
+                // 接受状态: S' -> S .
+                actionTable[i]["#"] = {'a', 0};
+            } 
+            else //规约
             {
-                //若存在
-                if (states[i].items == nextItemSet) 
+                //获取该项目在文法中对应的产生式的左部，利用follow集来判断是否存在冲突(rr和sr)
+                string A = grammar[item.prodIndex].lhs;
+                for (const auto& a : followSets[A]) 
                 {
-                    existingStateId = i;
-                    break;
+                    if (actionTable[i].count(a)) 
+                    {
+                        // 冲突检测 ·
+                        
+                        if (actionTable[i][a].type == 's') 
+                        {
+                            // 移进-归约冲突: 尝试用优先级和结合性消解
+                            char how = resolveShiftReduce(grammar[item.prodIndex], a);
+                            if (how == 0) 
+                            {
+                                cout << "错误：存在移进规约冲突，位于状态 " << i << " 符号 " << a << endl;
+                                return false;
+                            }
+                            resolvedConflicts++;
+                            if (how == 's') continue;
+                            if (how == 'e') 
+                            {
+                                actionTable[i][a] = {'e', 0};
+                                continue;
+                            }
+                        }
+                        // 已被 %nonassoc 置为错误的条目保持不变
+                        else if (actionTable[i][a].type == 'e') 
+                            continue;
+                         // 如果表中已经存在动作，且是归约('r')，并且产生式编号不同
+                        else if (actionTable[i][a].type == 'r' && actionTable[i][a].val != item.prodIndex) 
+                        {
+                            // 归约-归约冲突
+                            cout << "错误：存在归约归约冲突，位于状态 " << i << " 符号 " << a << endl;
+                            return false;
+                        }
+                    }
+                    //填写action表的规约动作，r表示动作，item.proIndex表示该项目对应的产生式的下标
+                    actionTable[i][a] = {'r', item.prodIndex};
                 }
             }
-            
-            // 若不存在，添加新状态（设置该状态集合的ID和项目集合）
-            if (existingStateId == -1) 
-            {
-                existingStateId = states.size();
-                states.push_back({existingStateId, nextItemSet});//第一个id表示状态集的编号In,第二个表示存入状态集的项目集合
-            }
-            
-            // 记录状态集的第三个属性：transitions,记录转移关系 I0--X-->I1
-            
-            states[processed].transitions[X] = existingStateId;
         }
-        processed++;
     }
+    return true;
 }
 
 /**
@@ -307,77 +498,26 @@ void GrammarAnalyzer::buildDFA()
  */
 bool GrammarAnalyzer::buildSLRTable() 
 {
+    int resolvedConflicts = 0; // 用优先级消解的移进-归约冲突个数
     for (int i = 0; i < states.size(); ++i) //遍历状态表
     {
-        const State& S = states[i];
-        
-        // 1. 处理 Shift 动作 (移进) 和 GOTO表
-        // 根据map<string int> transition状态转移表: 输入符号 -> 目标状态ID
-        // 若有转移 state[i] --a--> state[j] 且 a 是终结符，则 Action[i][a] = sj
-        for (const auto& trans : S.transitions) 
-        {
-            string symbol = trans.first;//trans的第一个属性表示终结符
-            int target = trans.second;//第二个属性表示下一个状态ID
-            // 如果是终结符 填入ACTION表中
-            if (isTerminal(symbol)) 
-            {
-                if (actionTable[i].count(symbol)) 
-                {
-                    //如果ACTION表中在同一行存在关于终结符symbol的动作(移进/规约)，说明存在移进规约冲突，直接返回false
-                    cout << "错误：存在移进规约冲突，位于状态 " << i << " 符号 " << symbol << endl;
-                    return false;
-                }
-                //移进{s,target}.s表示移进，target是下一个状态
-                actionTable[i][symbol] = {'s', target};
-            } 
-            else 
-            {
-                // 若 a 是非终结符E或者T等等填入GOTO表，则 Goto[i][a] = j 表示状态转移
-                // GOTO target下一个状态
-                gotoTable[i][symbol] = target;
-            }
-        }
-        
-        // 2. 处理 Reduce 动作 (归约)
-        // 只有圆点在最后时候才能规约
-        // 若项目 A -> alpha . 属于 state[i]，则对 Follow(A) 中的每个符号 a 都进行规约对应产生式的ID，Action[i][a] = r(prod_id)
-
-        // 遍历当前状态下的所有项目集，因为可能不止一个项目
-        for (const auto& item : S.items) 
-        {
-            if (item.dotPos == grammar[item.prodIndex].rhs.size()) 
-            { // 圆点在最后
-                // 如果项目对应的产生式是第一个产生式的话呢，就直接ACC接受，填入{'a',0}
-                if (grammar[item.prodIndex].lhs == startSymbol) //接受
-                {
-                    // 接受状态: S' -> S .
-                    actionTable[i]["#"] = {'a', 0};
-                } 
-                else //规约
-                {
-                    //获取该项目在文法中对应的产生式的左部，利用follow集来判断是否存在冲突(rr和sr)
-                    string A = grammar[item.prodIndex].lhs;
-                    for (const auto& a : followSets[A]) 
-                    {
-                        if (actionTable[i].count(a)) 
-                        {
-                            // 冲突检测 ·
-                            
-                            if (actionTable[i][a].type == 's') 
-                                return false; // 移进-归约冲突
-                             // 如果表中已经存在动作，且是归约('r')，并且产生式编号不同
-                            if (actionTable[i][a].type == 'r' && actionTable[i][a].val != item.prodIndex) 
-                                return false; // 归约-归约冲突
-                        }
-                        //填写action表的规约动作，r表示动作，item.proIndex表示该项目对应的产生式的下标
-                        actionTable[i][a] = {'r', item.prodIndex};
-                    }
-                }
-            }
-        }
+        if (!fillRow(i, resolvedConflicts)) 
+            return false;
     }
 
-    // 打印 SLR(1) 分析表
+    if (resolvedConflicts > 0 && verbose) 
+        cout << "使用优先级与结合性消解了 " << resolvedConflicts << " 处移进-归约冲突" << endl;
+
+    if (verbose) 
+        printTable();
+    return true;
+}
+
+/**
+ * @brief 打印 SLR(1) 分析表
+ */
+void GrammarAnalyzer::printTable() 
+{
     cout << "SLR(1) 分析表:" << endl;
     
     // 收集所有列头
@@ -403,9 +543,8 @@ bool GrammarAnalyzer::buildSLRTable()
     cout << endl;
 
     // 打印每一行
-    for (const auto& state : states) 
+    for (int s = 0; s < states.size(); ++s) 
     {
-        int s = state.id;
         cout << s << "\t";
         for (const auto& h : headers) 
         {
@@ -418,6 +557,7 @@ bool GrammarAnalyzer::buildSLRTable()
                     if (act.type == 's') cout << "s" << act.val;
                     else if (act.type == 'r') cout << "r" << act.val;
                     else if (act.type == 'a') cout << "acc";
+                    else if (act.type == 'e') cout << "err";
                 }
             } else {
                 // Goto 表
@@ -427,16 +567,334 @@ bool GrammarAnalyzer::buildSLRTable()
             }
             cout << "\t";
         }
+        if (s < (int)defaultReduce.size() && defaultReduce[s] >= 0) 
+            cout << "默认r" << defaultReduce[s];
         cout << endl;
     }
-
-    return true;
 }
 
 bool GrammarAnalyzer::build() 
 {
-    computeFirst();//构建First集
-    computeFollow();//构建Follow集
-    buildDFA();
+    // 各阶段的堆内存使用情况记录在 memoryReport() 中
+    {
+        MemoryPhase phase("First/Follow");
+        computeFirst();//构建First集
+        computeFollow();//构建Follow集
+    }
+    {
+        MemoryPhase phase("DFA");
+        indexSymbols();
+        buildDFA();
+    }
+    MemoryPhase phase("分析表");
     return buildSLRTable();
 }
+
+bool GrammarAnalyzer::buildLazy() 
+{
+    lazy = true;
+    {
+        MemoryPhase phase("First/Follow");
+        computeFirst();
+        computeFollow();
+    }
+    MemoryPhase phase("DFA");
+    indexSymbols();
+    addStartState();
+    rowReady.assign(1, 0);
+    return true;
+}
+
+void GrammarAnalyzer::ensureRow(int s) 
+{
+    if (rowReady[s]) return;
+
+    // 求出转移 (可能加入新状态，新状态的行留到访问时再算)，再填写本行
+    expandState(s);
+    int resolvedConflicts = 0;
+    if (!fillRow(s, resolvedConflicts)) 
+    {
+        actionTable.erase(s);
+        gotoTable.erase(s);
+    }
+    rowReady.resize(states.size(), 0);
+    rowReady[s] = 1;
+}
+
+void GrammarAnalyzer::loadEmbedded(const EmbeddedTableView& table) 
+{
+    startSymbol = string(table.nonTerms[table.startSymbol]);
+    for (int p = 0; p < table.numProds; ++p) 
+    {
+        vector<string> rhs;
+        for (int k = table.rhsBegin[p]; k < table.rhsBegin[p + 1]; ++k) 
+            rhs.push_back(string(table.rhs[k]));
+        grammar.push_back({p, string(table.nonTerms[table.prodLhs[p]]), rhs});
+    }
+
+    // 列号与编译期的符号下标一致 (均为字典序)，和 packTables() 的结果相同
+    packed = PackedTable();
+    packed.numTerms = table.numTerms;
+    packed.numNonTerms = table.numNonTerms;
+    for (int i = 0; i < table.numTerms; ++i) 
+    {
+        terminals.insert(string(table.terms[i]));
+        packed.termCol[string(table.terms[i])] = i;
+    }
+    for (int i = 0; i < table.numNonTerms; ++i) 
+    {
+        nonTerminals.insert(string(table.nonTerms[i]));
+        packed.nonTermCol[string(table.nonTerms[i])] = i;
+    }
+    packed.action.assign(table.action, table.action + table.numStates * table.numTerms);
+    packed.goTo.assign(table.goTo, table.goTo + table.numStates * table.numNonTerms);
+    packed.ready = true;
+
+    // 只保留状态个数，没有项目集
+    states.reset(table.numStates);
+}
+
+void GrammarAnalyzer::releaseBuildData() 
+{
+    if (lazy) return;
+    states.release();
+}
+
+/**
+ * @brief 单产生式归约消除
+ * 1. 找出所有"单产生式归约状态": 只含一个项目 A -> X . ，且该产生式不是拓广产生式
+ *    (这类状态没有移进，对 Follow(A) 中的任何符号都归约同一条产生式)
+ * 2. 对每个状态 s 的移进和 Goto 表项，若目标 t 是单产生式归约状态，
+ *    则改为 Goto[s][A]，并沿单产生式链继续跟下去
+ * 目标状态 Goto[s][A] 的所有动作都在 Follow(A) 之内，因此出错位置最多推迟一步，不会接受非法输入
+ */
+int GrammarAnalyzer::eliminateUnitReductions() 
+{
+    // 1. 每个状态若为单产生式归约状态，记录其产生式下标，否则为 -1
+    vector<int> unitProd(states.size(), -1);
+    // 圆点在最后的核心项目没有可展开的符号，因此只含这一个核心项目的状态闭包也只有它
+    for (int s = 0; s < states.size(); ++s) 
+    {
+        StateView S = states[s];
+        if (S.kernel.size() != 1) continue;
+        const Item& item = S.kernel[0];
+        const Production& prod = grammar[item.prodIndex];
+        if (prod.rhs.size() == 1 && item.dotPos == 1 && prod.lhs != startSymbol) 
+            unitProd[S.id] = item.prodIndex;
+    }
+
+    // 2. 从状态 s 出发，跟随单产生式链得到最终目标
+    auto follow = [&](int s, int target) -> int {
+        for (int guard = 0; guard < states.size() && unitProd[target] >= 0; ++guard) 
+        {
+            auto row = gotoTable.find(s);
+            if (row == gotoTable.end()) break;
+            auto it = row->second.find(grammar[unitProd[target]].lhs);
+            if (it == row->second.end()) break;
+            target = it->second;
+        }
+        return target;
+    };
+
+    int rewritten = 0;
+    for (auto& row : actionTable) 
+    {
+        int s = row.first;
+        for (auto& entry : row.second) 
+        {
+            if (entry.second.type != 's') continue;
+            int target = follow(s, entry.second.val);
+            if (target != entry.second.val) 
+            {
+                entry.second.val = target;
+                rewritten++;
+            }
+        }
+    }
+    for (auto& row : gotoTable) 
+    {
+        int s = row.first;
+        for (auto& entry : row.second) 
+        {
+            int target = follow(s, entry.second);
+            if (target != entry.second) 
+            {
+                entry.second = target;
+                rewritten++;
+            }
+        }
+    }
+    return rewritten;
+}
+
+int GrammarAnalyzer::markDefaultReductions() 
+{
+    defaultReduce.assign(states.size(), -1);
+    int marked = 0;
+    for (int s = 0; s < (int)states.size(); ++s) 
+    {
+        auto rowIt = actionTable.find(s);
+        if (rowIt == actionTable.end() || rowIt->second.empty()) continue;
+        if (gotoTable.count(s) && !gotoTable[s].empty()) continue;
+
+        // 整行必须都是对同一条产生式的归约
+        int prod = -1;
+        bool single = true;
+        for (const auto& entry : rowIt->second) 
+        {
+            if (entry.second.type != 'r' || (prod >= 0 && entry.second.val != prod)) 
+            {
+                single = false;
+                break;
+            }
+            prod = entry.second.val;
+        }
+        if (!single) continue;
+
+        defaultReduce[s] = prod;
+        actionTable.erase(rowIt);
+        marked++;
+    }
+    return marked;
+}
+
+int GrammarAnalyzer::actionEntryCount() const 
+{
+    int count = 0;
+    for (const auto& row : actionTable) count += row.second.size();
+    return count;
+}
+
+void GrammarAnalyzer::packTables() 
+{
+    packed = PackedTable();
+
+    // 1. 列号: 终结符按 terminalOrder (未指定时按字典序)，非终结符按字典序
+    vector<string> cols = terminalOrder;
+    if (cols.empty()) cols.assign(terminals.begin(), terminals.end());
+    for (const auto& t : cols) 
+    {
+        int col = packed.numTerms++;
+        packed.termCol[t] = col;
+    }
+    for (const auto& nt : nonTerminals) 
+    {
+        int col = packed.numNonTerms++;
+        packed.nonTermCol[nt] = col;
+    }
+
+    // 2. 按行优先填入连续数组
+    packed.action.assign(states.size() * packed.numTerms, {'e', 0});
+    packed.goTo.assign(states.size() * packed.numNonTerms, -1);
+    for (const auto& row : actionTable) 
+    {
+        for (const auto& entry : row.second) 
+            packed.action[row.first * packed.numTerms + packed.termCol[entry.first]] = entry.second;
+    }
+    for (const auto& row : gotoTable) 
+    {
+        for (const auto& entry : row.second) 
+            packed.goTo[row.first * packed.numNonTerms + packed.nonTermCol[entry.first]] = entry.second;
+    }
+    packed.ready = true;
+}
+
+vector<int> GrammarAnalyzer::renumberStates(const vector<long long>& stateHits, const map<string, long long>& terminalHits) 
+{
+    int n = states.size();
+    auto hits = [&](int s) -> long long { return s < (int)stateHits.size() ? stateHits[s] : 0; };
+
+    // 1. 新顺序: 初始状态 0 在最前，其余按访问次数降序 (次数相同保持原顺序)
+    vector<int> order;
+    for (int s = 1; s < n; ++s) order.push_back(s);
+    stable_sort(order.begin(), order.end(), [&](int x, int y) { return hits(x) > hits(y); });
+    order.insert(order.begin(), 0);
+
+    vector<int> newId(n);
+    for (int i = 0; i < n; ++i) newId[order[i]] = i;
+
+    // 2. 按新编号重建状态集、Action 表、Goto 表和默认归约表
+    states.renumber(order, newId);
+
+    map<int, map<string, Action>> newAction;
+    for (const auto& row : actionTable) 
+    {
+        map<string, Action>& newRow = newAction[newId[row.first]];
+        for (const auto& entry : row.second) 
+        {
+            Action act = entry.second;
+            if (act.type == 's') act.val = newId[act.val];
+            newRow[entry.first] = act;
+        }
+    }
+    actionTable = newAction;
+
+    map<int, map<string, int>> newGoto;
+    for (const auto& row : gotoTable) 
+    {
+        for (const auto& entry : row.second) 
+            newGoto[newId[row.first]][entry.first] = newId[entry.second];
+    }
+    gotoTable = newGoto;
+
+    if (!defaultReduce.empty()) 
+    {
+        vector<int> newDefault(n, -1);
+        for (int s = 0; s < n; ++s) newDefault[newId[s]] = defaultReduce[s];
+        defaultReduce = newDefault;
+    }
+
+    // 3. 终结符列按查表次数降序排列
+    terminalOrder.assign(terminals.begin(), terminals.end());
+    auto termHits = [&](const string& t) -> long long {
+        auto it = terminalHits.find(t);
+        return it == terminalHits.end() ? 0 : it->second;
+    };
+    stable_sort(terminalOrder.begin(), terminalOrder.end(),
+                [&](const string& x, const string& y) { return termHits(x) > termHits(y); });
+
+    if (packed.ready) packTables();
+    return newId;
+}
+
+Action GrammarAnalyzer::lookupAction(int s, const string& a) 
+{
+    unique_lock<mutex> lock(lazyMutex, defer_lock);
+    if (lazy) 
+    {
+        lock.lock();
+        ensureRow(s);
+    }
+    else if (packed.ready) 
+    {
+        auto col = packed.termCol.find(a);
+        if (col == packed.termCol.end()) return {'e', 0};
+        return packed.action[s * packed.numTerms + col->second];
+    }
+    auto row = actionTable.find(s);
+    if (row == actionTable.end()) return {'e', 0};
+    auto it = row->second.find(a);
+    if (it == row->second.end()) return {'e', 0};
+    return it->second;
+}
+
+int GrammarAnalyzer::lookupGoto(int s, const string& A) 
+{
+    unique_lock<mutex> lock(lazyMutex, defer_lock);
+    if (lazy) 
+    {
+        lock.lock();
+        ensureRow(s);
+    }
+    else if (packed.ready) 
+    {
+        auto col = packed.nonTermCol.find(A);
+        if (col == packed.nonTermCol.end()) return -1;
+        return packed.goTo[s * packed.numNonTerms + col->second];
+    }
+    auto row = gotoTable.find(s);
+    if (row == gotoTable.end()) return -1;
+    auto it = row->second.find(A);
+    if (it == row->second.end()) return -1;
+    return it->second;
+}
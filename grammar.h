@@ -2,16 +2,26 @@
 #define GRAMMAR_H
 
 #include "common.h"
+#include "memory.h"
+#include "lexgen.h"
+#include "statestore.h"
+#include "embedded.h"
+#include <mutex>
 
 /**
- * @brief DFA 状态结构体
- * 代表 LR 分析中的一个状态，包含项目集和转移关系
+ * @brief 紧凑的二维分析表
+ * Action/Goto 表按行优先存放在连续数组中，列号由符号映射得到，
+ * 状态编号和终结符列的顺序可以按运行时的访问频率重排，使常用的表项集中在一起
  */
-struct State 
+struct PackedTable 
 {
-    int id;                         // 状态编号
-    set<Item> items;                // 该状态包含的 LR(0) 项目集合
-    map<string, int> transitions;   // 状态转移表: 输入符号 -> 目标状态ID
+    bool ready = false;             // 是否已经生成
+    int numTerms = 0;               // Action 表列数
+    int numNonTerms = 0;            // Goto 表列数
+    map<string, int> termCol;       // 终结符 -> 列号
+    map<string, int> nonTermCol;    // 非终结符 -> 列号
+    vector<Action> action;          // [状态 * numTerms + 列号]，空表项为 {'e', 0}
+    vector<int> goTo;               // [状态 * numNonTerms + 列号]，空表项为 -1
 };
 
 /**
@@ -26,27 +36,146 @@ public:
     set<string> terminals;          // 终结符集合
     set<string> nonTerminals;       // 非终结符集合
     string startSymbol;             // 开始符号
+
+    // 优先级与结合性声明 (%left / %right / %nonassoc)，用于消解移进-归约冲突
+    // 终结符 -> (优先级, 结合性 'l'/'r'/'n')，后声明的行优先级更高
+    map<string, pair<int, char>> precedence;
+
+    // 词法定义 (%token 名字 正则 / %skip 正则)，按声明顺序排列
+    // 存在 %token 声明时由它们和文法中的字面量终结符生成 lexTable，否则使用手写的词法分析器
+    vector<TokenDef> tokenDefs;
+    LexTable lexTable;
     
     // 集合计算结果
     map<string, set<string>> firstSets;  // First 集
     map<string, set<string>> followSets; // Follow 集
     
+    // 符号编号 (构建时生成): 终结符与非终结符统一按名字的字典序编号
+    vector<string> symbols;                      // [编号] -> 符号名
+    map<string, int> symbolId;                   // 符号名 -> 编号
+    vector<char> symbolIsTerminal;               // [编号] -> 是否为终结符
+    vector<vector<int>> rhsSymbols;              // [产生式] -> 右部的符号编号
+    vector<vector<int>> prodsOf;                 // [非终结符编号] -> 以它为左部的产生式
+    bool hasEmptyProduction = false;             // 是否存在右部为空的产生式
+
     // 分析表相关数据
-    vector<State> states;                        // DFA 状态集
+    StateStore states;                           // DFA 状态集 (列式存储，只保存核心项目与转移)
     map<int, map<string, Action>> actionTable;   // Action 表: [状态][终结符] -> 动作
     map<int, map<string, int>> gotoTable;        // Goto 表: [状态][非终结符] -> 目标状态
 
+    vector<int> defaultReduce;                   // 默认归约: [状态] -> 产生式下标，-1 表示需要查 Action 表
+    vector<string> terminalOrder;                // 紧凑表中终结符列的顺序 (为空时按字典序)
+    PackedTable packed;                          // 紧凑分析表，生成后分析器优先使用
+
+    bool verbose = true;                         // 构建时是否打印分析表
+
+    // 惰性模式 (buildLazy())：状态的 Action/Goto 行在分析器第一次查到时才计算，结果缓存下来供之后的分析共用
+    bool lazy = false;
+    vector<char> rowReady;                       // [状态] -> 该行是否已经计算
+    mutex lazyMutex;                             // 惰性模式下查表会修改表，多个分析器共用时串行化
+
     /**
      * 从文件加载文法
+     * 每行一条产生式 LHS -> RHS；以 %left、%right、%nonassoc 开头的行声明终结符的结合性，
+     * 越靠后的声明行优先级越高；
+     * %token 名字 正则 声明一类 Token (如 %token id [A-Za-z_]\w*)，%skip 正则 声明需要跳过的内容，
+     * 文法中其余的终结符作为字面量原样匹配
      */
     void loadGrammar(const string& filename);
 
+    /**
+     * @brief 从输入流加载文法 (格式同上)
+     */
+    void loadGrammar(istream& in);
+
+    /**
+     * @brief 装入编译期生成的分析表 (代替 loadGrammar() + build())
+     * 只复制产生式、符号表和紧凑表数组，不计算 First/Follow 集、不构造项目集；
+     * 没有 Action/Goto 映射表和项目集，因此不能再做单产生式归约消除、默认归约等变换
+     */
+    void loadEmbedded(const EmbeddedTableView& table);
+
     /**
      * @brief 执行完整的构建流程
      * 包括计算 First/Follow 集，构造 DFA，生成分析表
      * @return 如果成功生成 SLR(1) 表返回 true，否则返回 false
      */
     bool build(); 
+
+    /**
+     * @brief 惰性构建 (代替 build())
+     * 只计算 First/Follow 集和初始状态的项目集，其余状态及其 Action/Goto 行由 lookupAction()/lookupGoto()
+     * 第一次访问时计算 (求转移目标的闭包、填写移进/归约/Goto 表项)。
+     * 大文法中输入只用到一小部分时，可以省去构造整个项目集规范族的启动时间和内存。
+     * 冲突在计算到该行时才会发现，此时与 build() 一样打印冲突，并把该行置空
+     * (Action 查不到动作、Goto 查不到转移，Parser 在该状态报语法错误并停止)。
+     * 惰性模式下的状态编号按访问顺序分配，与 build() 不同；不能再做紧凑表和各种表变换
+     * @return 总是返回 true
+     */
+    bool buildLazy();
+
+    /**
+     * @brief 释放构建期数据 (分析表冻结后调用)
+     * 释放状态存储中的核心项目与转移数组，Action/Goto 表、紧凑表和状态个数保留。
+     * 之后不能再调用 eliminateUnitReductions()、renumberStates() 等依赖项目集的变换。
+     * 惰性模式下项目集还要用于计算后续的行，不做任何事
+     */
+    void releaseBuildData();
+
+    /**
+     * @brief 单产生式归约消除 (在 build() 之后调用)
+     * 若某状态只含一个项目 A -> X . 且该单产生式没有语义效果 (仅传递属性)，
+     * 则所有移进/转移到该状态的表项直接改为转移到 Goto[s][A] (沿单产生式链一直跟到底)，
+     * 分析时不再经过这次 弹栈-查Goto-压栈 的归约，属性原样留在栈上
+     * @return 被改写的表项个数
+     */
+    int eliminateUnitReductions();
+
+    /**
+     * @brief 标记默认归约状态 (在 build() 之后调用)
+     * 若某状态的 Action 行只有对同一条产生式的归约 (没有移进、接受或 Goto)，
+     * 则把它标记为默认归约状态并删除该行，分析器在该状态下不读向前看符号、不查表，直接归约
+     * @return 被标记的状态个数
+     */
+    int markDefaultReductions();
+
+    /**
+     * @brief Action 表中的条目总数
+     */
+    int actionEntryCount() const;
+
+    /**
+     * @brief 根据当前 Action/Goto 表生成紧凑的二维数组表 packed
+     * 终结符列按 terminalOrder 排列
+     */
+    void packTables();
+
+    /**
+     * @brief 按访问频率重新编号状态 (剖析引导的优化，在 build() 之后调用)
+     * 状态 0 (初始状态) 保持不变，其余状态按访问次数从高到低编号；
+     * 终结符列按作为向前看符号的查表次数排序。已生成的紧凑表会重新生成
+     * @param stateHits [状态] -> 访问次数
+     * @param terminalHits 终结符 -> 查表次数
+     * @return [旧状态编号] -> 新状态编号
+     */
+    vector<int> renumberStates(const vector<long long>& stateHits, const map<string, long long>& terminalHits);
+
+    /**
+     * @brief 查 Action 表 (有紧凑表时查紧凑表，惰性模式下该行尚未计算时先计算)
+     * @return 表项，不存在时返回 {'e', 0}
+     */
+    Action lookupAction(int s, const string& a);
+
+    /**
+     * @brief 查 Goto 表 (有紧凑表时查紧凑表，惰性模式下该行尚未计算时先计算)
+     * @return 目标状态，不存在时返回 -1
+     */
+    int lookupGoto(int s, const string& A);
+
+    /**
+     * @brief 打印 SLR(1) 分析表
+     */
+    void printTable();
     
 private:
     
@@ -54,12 +183,28 @@ private:
     void computeFollow(); // 计算 Follow 集
     
     
-    set<Item> closure(set<Item> I); // 计算项目集闭包
-    set<Item> gotoState(const set<Item>& I, const string& X); // 计算状态转移
+    void indexSymbols();  // 为符号编号，产生式右部转为符号编号
+    vector<Item> closure(const vector<Item>& kernel); // 由核心项目计算项目集闭包
     void buildDFA();      // 构造 LR(0) 项目集规范族 (DFA)
+    void addStartState(); // 加入初始状态 (核心项目 S' -> . S)
+    void expandState(int processed); // 计算一个状态的全部转移 Goto(I, X)，新的核心项目作为新状态加入
     bool buildSLRTable(); // 根据 DFA 和 Follow 集构造 SLR(1) 分析表
+    bool fillRow(int i, int& resolvedConflicts); // 填写一个状态的 Action/Goto 行
+    void ensureRow(int s); // 惰性模式下保证状态 s 的行已经计算 (调用者持有 lazyMutex)
     
     bool isTerminal(const string& s); // 判断是否为终结符
+
+    /**
+     * @brief 产生式的优先级: 取右部最后一个声明了优先级的终结符
+     * @return 优先级，未声明时返回 -1
+     */
+    int productionPrecedence(const Production& prod);
+
+    /**
+     * @brief 利用优先级与结合性消解状态 state 在符号 a 上的移进-归约冲突
+     * @return 's' 保留移进，'r' 改为归约，'e' 置为错误 (%nonassoc)，0 表示无法消解
+     */
+    char resolveShiftReduce(const Production& prod, const string& a);
 };
 
 #endif
@@ -0,0 +1,278 @@
+#include "incremental.h"
+#include "optimizer.h"
+#include "lexer.h"
+#include <cctype>
+
+IncrementalParser::IncrementalParser(GrammarAnalyzer& grammar)
+    : G(grammar), parser(grammar), failed(0), backpatch(false), recycleTemps(false),
+      reparsed(0), firstReparsed(0), reused(0), relexedBytes(0)
+{
+    parser.verbose = false;
+    parser.placeholderNames = true;
+    checkpointState = G.lookupGoto(0, G.grammar[0].rhs[0]);
+}
+
+bool IncrementalParser::scanFrom(size_t start, vector<StatementFragment>& fresh, const function<bool(size_t)>& synced)
+{
+    const size_t kFeed = 4096; // 每次送入词法分析器的字节数，同步后不再读取后面的代码
+    Lexer lexer(&G.lexTable);
+    size_t fed = start;
+    vector<size_t> tokenEnds;  // 当前段中已送入分析器的各 Token 的结束位置
+    long long shiftBase = 0;   // tokenEnds[0] 对应的移进序号
+    size_t fragBegin = start;
+    vector<Quad> code;
+    bool stop = false;
+
+    // 流式模式: 每个检查点处四元式已全部送出，收下这一段并从 1 开始重新编号
+    parser.backpatch = backpatch;
+    parser.reset();
+    parser.sink = [&](const Quad& q) { code.push_back(q); };
+    parser.onTopLevel = [&]() {
+        if (stop || parser.topState() != checkpointState) return;
+        // 检查点在最后移进的 Token 之后 (触发归约的向前看符号尚未移进)
+        long long shifted = parser.stats.shifts - shiftBase;
+        size_t cut = tokenEnds[shifted - 1];
+        tokenEnds.erase(tokenEnds.begin(), tokenEnds.begin() + shifted);
+        shiftBase = parser.stats.shifts;
+        fresh.push_back({cut - fragBegin, move(code), parser.numbering(), true});
+        code.clear();
+        parser.restartNumbering();
+        fragBegin = cut;
+        stop = synced(cut);
+    };
+
+    while (!stop)
+    {
+        Token tok;
+        if (!lexer.tryNext(tok))
+        {
+            if (fed < src.size())
+            {
+                size_t n = min(kFeed, src.size() - fed);
+                lexer.feed(src.substr(fed, n));
+                fed += n;
+            }
+            else lexer.finish();
+            continue;
+        }
+        tokenEnds.push_back(start + lexer.offset());
+        ParseStatus status = parser.pushToken(tok);
+        if (status == PARSE_ACCEPT)
+        {
+            // 最后一段延伸到源代码末尾 (包括结尾的空白)
+            if (!fresh.empty()) fresh.back().length += src.size() - fragBegin;
+            break;
+        }
+        if (status == PARSE_ERROR)
+        {
+            fresh.push_back({src.size() - fragBegin, {}, {0, 0}, false});
+            break;
+        }
+    }
+    parser.sink = nullptr;
+    parser.onTopLevel = nullptr;
+    for (const auto& f : fresh) relexedBytes += f.length;
+    reparsed += fresh.size();
+    return stop;
+}
+
+bool IncrementalParser::parse(const string& source)
+{
+    src = source;
+    fragments.clear();
+    failed = reparsed = reused = firstReparsed = 0;
+    relexedBytes = 0;
+    scanFrom(0, fragments, [](size_t) { return false; });
+    rebuildTree();
+    for (const auto& f : fragments)
+    {
+        if (!f.ok) failed++;
+    }
+    return failed == 0;
+}
+
+bool IncrementalParser::edit(size_t begin, size_t end, const string& text)
+{
+    if (fragments.empty()) return parse(src.substr(0, begin) + text + src.substr(end));
+    reparsed = reused = 0;
+    relexedBytes = 0;
+    long long delta = (long long)text.size() - (long long)(end - begin);
+    src.replace(begin, end - begin, text);
+
+    // 1. 受影响的第一段: 起点在 begin 之前的最后一段 (它之前的段文本未变，且不会被修改延长最后一个 Token)
+    //    检查点处的归约由向前看符号即该段的第一个 Token 决定，修改可能改变这个 Token 时
+    //    (它之后到 begin 之间没有空白)，上一条语句可能随之延长 (如 "x = a" 的下一行变为 "+ b")，再退回一段
+    int n = fragments.size();
+    int first = fragmentBefore(begin);
+    size_t start = prefix(first).bytes;
+    size_t tokenEnd = start;
+    while (tokenEnd < begin && isspace((unsigned char)src[tokenEnd])) tokenEnd++;
+    while (tokenEnd < begin && !isspace((unsigned char)src[tokenEnd])) tokenEnd++;
+    if (tokenEnd >= begin && first > 0)
+    {
+        first--;
+        start -= fragments[first].length;
+    }
+    firstReparsed = first;
+
+    // 2. 从该段起只剩空白 (如删掉了最后几条语句): 并入上一段
+    size_t i = start;
+    while (i < src.size() && isspace((unsigned char)src[i])) i++;
+    if (i == src.size() && first > 0)
+    {
+        for (int k = first; k < n; ++k)
+        {
+            if (!fragments[k].ok) failed--;
+        }
+        fragments.erase(fragments.begin() + first, fragments.end());
+        tree.resize(first + 1); // 树状数组的前 first 项只与前 first 段有关，截断即可
+        FragmentTotals before = sizeOf(fragments.back());
+        fragments.back().length += src.size() - start;
+        updateTree(first - 1, before, sizeOf(fragments.back()));
+        reused = fragments.size();
+        return failed == 0;
+    }
+
+    // 3. 从该段的检查点开始重新分析，直到新检查点与修改区之后的旧检查点重合
+    int j = first;
+    long long oldEnd = start + fragments[first].length; // 第 j 段在修改前的结束位置
+    int resume = n; // 从这一段起原样复用
+    auto synced = [&](size_t cut) {
+        while (j < n && (oldEnd < (long long)end || oldEnd + delta < (long long)cut))
+        {
+            if (++j < n) oldEnd += fragments[j].length;
+        }
+        if (j < n && oldEnd + delta == (long long)cut)
+        {
+            resume = j + 1;
+            return true;
+        }
+        return false;
+    };
+    vector<StatementFragment> fresh;
+    scanFrom(start, fresh, synced);
+
+    // 4. 用新切出的段替换旧段；之后的段只记录长度，不需要平移
+    for (int k = first; k < resume; ++k)
+    {
+        if (!fragments[k].ok) failed--;
+    }
+    for (const auto& f : fresh)
+    {
+        if (!f.ok) failed++;
+    }
+    reused = n - (resume - first);
+    if ((int)fresh.size() == resume - first)
+    {
+        // 段数不变: 逐段替换，只更新树状数组中这几段
+        for (size_t k = 0; k < fresh.size(); ++k)
+        {
+            StatementFragment& f = fragments[first + k];
+            FragmentTotals before = sizeOf(f);
+            f = move(fresh[k]);
+            updateTree(first + k, before, sizeOf(f));
+        }
+    }
+    else
+    {
+        fragments.erase(fragments.begin() + first, fragments.begin() + resume);
+        fragments.insert(fragments.begin() + first, make_move_iterator(fresh.begin()), make_move_iterator(fresh.end()));
+        rebuildTree();
+    }
+    return failed == 0;
+}
+
+FragmentTotals IncrementalParser::sizeOf(const StatementFragment& f)
+{
+    return {f.length, f.code.size(), f.numbering.temps, f.numbering.labels};
+}
+
+void IncrementalParser::rebuildTree()
+{
+    int n = fragments.size();
+    tree.assign(n + 1, {0, 0, 0, 0});
+    for (int i = 1; i <= n; ++i)
+    {
+        tree[i] += sizeOf(fragments[i - 1]);
+        int parent = i + (i & -i);
+        if (parent <= n) tree[parent] += tree[i];
+    }
+}
+
+void IncrementalParser::updateTree(int k, const FragmentTotals& from, const FragmentTotals& to)
+{
+    FragmentTotals delta = {to.bytes - from.bytes, to.quads - from.quads, to.temps - from.temps, to.labels - from.labels};
+    for (int i = k + 1; i < (int)tree.size(); i += i & -i) tree[i] += delta;
+}
+
+FragmentTotals IncrementalParser::prefix(int k) const
+{
+    FragmentTotals sum = {0, 0, 0, 0};
+    for (int i = k; i > 0; i -= i & -i) sum += tree[i];
+    return sum;
+}
+
+int IncrementalParser::fragmentBefore(size_t pos) const
+{
+    // 在树状数组上自高位向低位逼近: 找最大的 k 使前 k 段的字节数之和 < pos
+    int n = fragments.size();
+    int k = 0;
+    size_t sum = 0;
+    int step = 1;
+    while (step * 2 <= n) step *= 2;
+    for (; step > 0; step /= 2)
+    {
+        if (k + step <= n && sum + tree[k + step].bytes < pos)
+        {
+            k += step;
+            sum += tree[k].bytes;
+        }
+    }
+    return min(k, n - 1);
+}
+
+const string& IncrementalParser::source() const
+{
+    return src;
+}
+
+int IncrementalParser::fragmentCount() const
+{
+    return fragments.size();
+}
+
+size_t IncrementalParser::fragmentBegin(int k) const
+{
+    return prefix(k).bytes;
+}
+
+vector<Quad> IncrementalParser::fragmentCode(int k) const
+{
+    FragmentTotals base = prefix(k);
+    vector<Quad> piece = fragments[k].code;
+    rebaseQuads(piece, base.temps, base.labels, base.quads);
+    return piece;
+}
+
+vector<Quad> IncrementalParser::assemble() const
+{
+    size_t total = 0;
+    for (const auto& f : fragments) total += f.code.size();
+    vector<Quad> result;
+    result.reserve(total);
+    QuadNumbering base = {0, 0};
+    for (const auto& f : fragments)
+    {
+        vector<Quad> piece = f.code;
+        rebaseQuads(piece, base.temps, base.labels, result.size(), recycleTemps);
+        base.temps += f.numbering.temps;
+        base.labels += f.numbering.labels;
+        result.insert(result.end(), make_move_iterator(piece.begin()), make_move_iterator(piece.end()));
+    }
+    if (recycleTemps)
+    {
+        renumberTemps(result);
+        rebaseQuads(result, 0, 0, 0);
+    }
+    return result;
+}
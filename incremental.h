@@ -0,0 +1,156 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "common.h"
+#include "grammar.h"
+#include "parser.h"
+#include "parallel.h"
+#include <functional>
+
+/**
+ * @brief 一段顶层语句及其分析结果
+ * 段的末尾是一个检查点 (该处最后一个 Token 的结束位置)，最后一段延伸到源代码末尾。
+ * 段只记录自身的长度，起点由之前各段的长度之和得到 (见 IncrementalParser::fragmentBegin())
+ */
+struct StatementFragment
+{
+    size_t length;             // 这一段的字节数
+    vector<Quad> code;         // 这一段的四元式 (生成的临时变量、标号带保留前缀，与单独分析这一段时的编号相同)
+    QuadNumbering numbering;   // 分析这一段时分配的临时变量与标号个数
+    bool ok;                   // 这一段是否分析成功 (出错时这一段延伸到源代码末尾)
+};
+
+/**
+ * @brief 若干段合计的字节数、四元式条数、临时变量与标号个数
+ * 前 k 段之和即第 k 段的起点和重新编号的基数
+ */
+struct FragmentTotals
+{
+    size_t bytes, quads;
+    int temps, labels;
+
+    FragmentTotals& operator+=(const FragmentTotals& o)
+    {
+        bytes += o.bytes;
+        quads += o.quads;
+        temps += o.temps;
+        labels += o.labels;
+        return *this;
+    }
+};
+
+/**
+ * @brief 增量语法分析器
+ *
+ * 检查点取自分析器的实际栈格局: 每当归约后分析栈回到 [0, goto(0, P)] (P 为 S' -> P 的右部，
+ * 对语句序列文法即归约 P -> P S 或 P -> S 之后)，此前的代码已全部确定 (见 Parser::streamPrefix())，
+ * 之后的分析与从初始状态开始分析剩余代码等价。因此每条顶层语句 (不论是否含花括号) 之后都是一个检查点，
+ * 保存两个检查点之间那段代码的长度和四元式。
+ *
+ * 修改一段字节后:
+ * 1. 从修改起点之前的最后一个检查点开始 (修改恰好从检查点开始时退回一个，修改可能延长它之前的 Token；
+ *    修改可能改变检查点之后的第一个 Token 即当时的向前看符号时也退回一个)，用流式词法分析器和语法分析器重新分析
+ * 2. 一旦新检查点与修改区之后某个旧检查点 (按长度变化平移后) 重合，分析状态即已重新同步，
+ *    其后的各段文本未变，原样复用其四元式
+ *
+ * 各段只保存长度和本段的编号个数，段的起点和重新编号的基数由树状数组 (按段号累加 FragmentTotals) 求得，
+ * 修改后只更新被替换的段，不改动其后各段。因此段数不变的修改 (如改一个数字) 工作量取决于修改所在的语句大小，
+ * 只多出对数级的树状数组更新；插入或删除整条语句使段数变化时，还要移动段数组、线性地重建树状数组 (每段一次加法，不涉及四元式)。
+ * 取改动后的代码用 fragmentCode() 按段取出 (只重新编号这一段)；assemble() 拼接出整个序列，
+ * 耗时与四元式总数成正比，结果与整体分析完全一致。
+ *
+ * 若修改造成语法错误 (如删掉一个 '}')，从出错的段到文件末尾作为一个失败的段，修复后再从该段重新分析
+ */
+class IncrementalParser
+{
+    GrammarAnalyzer& G;
+    Parser parser;
+    int checkpointState;                 // 检查点处的栈顶状态 goto(0, P)
+    string src;                          // 当前源代码
+    vector<StatementFragment> fragments; // 按位置排列的各段
+    vector<FragmentTotals> tree;         // 各段大小的树状数组 (下标从 1 开始，tree[i] 为第 i - lowbit(i) 段到第 i - 1 段之和)
+    int failed;                          // 分析失败的段数
+
+    static FragmentTotals sizeOf(const StatementFragment& f);
+
+    /**
+     * @brief 由 fragments 线性地重建树状数组
+     */
+    void rebuildTree();
+
+    /**
+     * @brief 第 k 段的大小由 from 变为 to (字节数、四元式条数按无符号数回绕相加，可以减少)
+     */
+    void updateTree(int k, const FragmentTotals& from, const FragmentTotals& to);
+
+    /**
+     * @brief 前 k 段之和
+     */
+    FragmentTotals prefix(int k) const;
+
+    /**
+     * @brief 起点在 pos 之前的最后一段 (pos 为 0 时为第 0 段)
+     */
+    int fragmentBefore(size_t pos) const;
+
+    /**
+     * @brief 从 start 处的检查点开始分析，新切出的各段追加到 fresh
+     * @param synced 每到一个新检查点调用一次，参数为其位置，返回 true 时停止分析
+     * @return 因 synced 返回 true 而停止时返回 true，分析到末尾 (接受或出错) 返回 false
+     */
+    bool scanFrom(size_t start, vector<StatementFragment>& fresh, const function<bool(size_t)>& synced);
+
+public:
+    bool backpatch;       ///< 是否使用回填方式生成条件与循环代码 (须在 parse() 之前设置)
+    bool recycleTemps;    ///< 是否在拼接后做活跃性分析并复用临时变量
+    int reparsed;         ///< 最近一次 parse()/edit() 重新分析的段数 (从第 firstReparsed 段开始)
+    int firstReparsed;    ///< 最近一次 parse()/edit() 重新分析的第一段
+    int reused;           ///< 最近一次 edit() 原样复用的段数
+    size_t relexedBytes;  ///< 最近一次 parse()/edit() 重新做词法分析的字节数
+
+    /**
+     * @param grammar 已构建好分析表的文法分析器 (语句序列文法)
+     */
+    IncrementalParser(GrammarAnalyzer& grammar);
+
+    /**
+     * @brief 完整分析一份源代码，建立各段与检查点
+     * @return 全部分析成功返回 true
+     */
+    bool parse(const string& source);
+
+    /**
+     * @brief 把当前源代码中 [begin, end) 的字节替换为 text，并增量地重新分析
+     * @return 修改后的整个源代码分析成功返回 true
+     */
+    bool edit(size_t begin, size_t end, const string& text);
+
+    /**
+     * @brief 当前源代码
+     */
+    const string& source() const;
+
+    /**
+     * @brief 段数
+     */
+    int fragmentCount() const;
+
+    /**
+     * @brief 第 k 段在当前源代码中的起点
+     */
+    size_t fragmentBegin(int k) const;
+
+    /**
+     * @brief 第 k 段在整体序列中的四元式: 按之前各段的编号个数重新编号，与 assemble() 结果中的相应部分相同
+     * (不做临时变量复用)，其第一条在整体序列中的下标为之前各段的四元式条数之和
+     */
+    vector<Quad> fragmentCode(int k) const;
+
+    /**
+     * @brief 重新编号并拼接各段的四元式，得到与 Parser::parse() 整体分析相同的结果
+     * 耗时与四元式总数成正比，只在需要完整输出时调用；只关心改动部分时用 fragmentCode()
+     */
+    vector<Quad> assemble() const;
+};
+
+#endif
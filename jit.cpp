@@ -0,0 +1,260 @@
+#include "jit.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SLR_JIT_X64 1
+#endif
+
+namespace
+{
+    // x86-64 通用寄存器编号
+    enum Reg { RAX = 0, RCX = 1, RDX = 2, RDI = 7, R8 = 8, R9 = 9, R10 = 10, R11 = 11 };
+
+    // 常驻变量可使用的寄存器 (调用者保存，无需在函数内保存)
+    const int kVarRegs[] = {R8, R9, R10, R11};
+    const int kVarRegCount = 4;
+
+    /**
+     * @brief 机器码缓冲区与指令编码
+     */
+    struct Emitter
+    {
+        vector<unsigned char> buf;
+
+        void byte(unsigned char b) { buf.push_back(b); }
+        void imm32(int v) { for (int i = 0; i < 4; ++i) byte((v >> (8 * i)) & 0xFF); }
+        void imm64(long long v) { for (int i = 0; i < 8; ++i) byte((v >> (8 * i)) & 0xFF); }
+
+        // REX.W 前缀，reg 为 ModRM.reg 字段，rm 为 ModRM.rm 字段
+        void rexW(int reg, int rm) { byte(0x48 | ((reg >> 3) & 1) << 2 | ((rm >> 3) & 1)); }
+        void modrmReg(int reg, int rm) { byte(0xC0 | (reg & 7) << 3 | (rm & 7)); }
+        void modrmEnv(int reg, int slot) { byte(0x80 | (reg & 7) << 3 | (RDI & 7)); imm32(slot * 8); }
+
+        void movRegReg(int dst, int src) { rexW(src, dst); byte(0x89); modrmReg(src, dst); }
+        void movRegEnv(int dst, int slot) { rexW(dst, RDI); byte(0x8B); modrmEnv(dst, slot); }
+        void movEnvReg(int slot, int src) { rexW(src, RDI); byte(0x89); modrmEnv(src, slot); }
+        void movRegImm(int dst, long long v) { byte(0x48 | ((dst >> 3) & 1)); byte(0xB8 + (dst & 7)); imm64(v); }
+        void addRegReg(int dst, int src) { rexW(src, dst); byte(0x01); modrmReg(src, dst); }
+        void subRegReg(int dst, int src) { rexW(src, dst); byte(0x29); modrmReg(src, dst); }
+        void imulRegReg(int dst, int src) { rexW(dst, src); byte(0x0F); byte(0xAF); modrmReg(dst, src); }
+        void cmpRegReg(int a, int b) { rexW(b, a); byte(0x39); modrmReg(b, a); }
+        void testRaxRax() { byte(0x48); byte(0x85); byte(0xC0); }
+        void setccAl(int cc) { byte(0x0F); byte(0x90 + cc); byte(0xC0); }
+        void movzxEaxAl() { byte(0x0F); byte(0xB6); byte(0xC0); }
+
+        // 返回 rel32 字段的位置，稍后回填
+        int jcc(int cc) { byte(0x0F); byte(0x80 + cc); imm32(0); return buf.size() - 4; }
+        int jmp() { byte(0xE9); imm32(0); return buf.size() - 4; }
+
+        void patchRel32(int pos, int targetOffset)
+        {
+            int rel = targetOffset - (pos + 4);
+            memcpy(&buf[pos], &rel, 4);
+        }
+    };
+
+    // 关系运算对应的条件码 (有符号比较)
+    int condCode(RelOp rel)
+    {
+        switch (rel)
+        {
+            case REL_GT: return 0xF;
+            case REL_LT: return 0xC;
+            case REL_EQ: return 0x4;
+            case REL_GE: return 0xD;
+            case REL_LE: return 0xE;
+            default:     return 0x5;
+        }
+    }
+}
+
+NativeCode::NativeCode() : mem(nullptr), size(0) {}
+
+NativeCode::~NativeCode()
+{
+    release();
+}
+
+void NativeCode::release()
+{
+    if (!mem) return;
+#if defined(_WIN32)
+    VirtualFree(mem, 0, MEM_RELEASE);
+#else
+    munmap(mem, size);
+#endif
+    mem = nullptr;
+    size = 0;
+}
+
+bool NativeCode::supported()
+{
+#ifdef SLR_JIT_X64
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NativeCode::compile(const LoweredProgram& prog, string& err)
+{
+    release();
+#ifndef SLR_JIT_X64
+    err = "本地代码后端仅支持 x86-64";
+    return false;
+#else
+    const vector<Instr>& code = prog.code;
+    int n = code.size();
+    int slotCount = prog.slotNames.size();
+
+    // 1. 统计每个槽位的引用次数，引用最多的变量分配到寄存器
+    vector<int> uses(slotCount, 0);
+    for (const auto& in : code)
+    {
+        if (!in.a.isImm && in.a.slot >= 0) uses[in.a.slot]++;
+        if (!in.b.isImm && in.b.slot >= 0) uses[in.b.slot]++;
+        if (in.dst >= 0) uses[in.dst]++;
+    }
+    vector<int> order(slotCount);
+    for (int i = 0; i < slotCount; ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int x, int y) { return uses[x] > uses[y]; });
+
+    vector<int> regOf(slotCount, -1);
+    vector<int> regSlots;
+    for (int i = 0; i < slotCount && i < kVarRegCount; ++i)
+    {
+        regOf[order[i]] = kVarRegs[i];
+        regSlots.push_back(order[i]);
+    }
+
+    Emitter e;
+    auto load = [&](int reg, const Operand& o) {
+        if (o.isImm) e.movRegImm(reg, o.imm);
+        else if (regOf[o.slot] >= 0) e.movRegReg(reg, regOf[o.slot]);
+        else e.movRegEnv(reg, o.slot);
+    };
+    auto storeRax = [&](int slot) {
+        if (regOf[slot] >= 0) e.movRegReg(regOf[slot], RAX);
+        else e.movEnvReg(slot, RAX);
+    };
+
+    // 2. 函数入口: 常驻寄存器的变量从 env 读入
+#if defined(_WIN32)
+    e.byte(0x57);              // push rdi (Win64 下 rdi 为被调用者保存寄存器)
+    e.movRegReg(RDI, RCX);     // 第一个参数在 rcx 中
+#endif
+    for (int slot : regSlots) e.movRegEnv(regOf[slot], slot);
+
+    // 3. 逐条指令生成代码，记录每条指令的起始偏移和待回填的跳转
+    vector<int> offset(n + 1);
+    vector<pair<int, int>> fixups; // (rel32 位置, 目标指令下标)
+    for (int i = 0; i < n; ++i)
+    {
+        const Instr& in = code[i];
+        offset[i] = e.buf.size();
+        switch (in.op)
+        {
+            case OP_NOP:
+                break;
+            case OP_MOV:
+                load(RAX, in.a);
+                storeRax(in.dst);
+                break;
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+                load(RAX, in.a);
+                load(RCX, in.b);
+                if (in.op == OP_ADD) e.addRegReg(RAX, RCX);
+                else if (in.op == OP_SUB) e.subRegReg(RAX, RCX);
+                else e.imulRegReg(RAX, RCX);
+                storeRax(in.dst);
+                break;
+            case OP_CMP:
+                load(RAX, in.a);
+                load(RCX, in.b);
+                e.cmpRegReg(RAX, RCX);
+                e.setccAl(condCode(in.rel));
+                e.movzxEaxAl();
+                storeRax(in.dst);
+                break;
+            case OP_JFALSE:
+            case OP_JTRUE:
+                load(RAX, in.a);
+                e.testRaxRax();
+                fixups.push_back({e.jcc(in.op == OP_JFALSE ? 0x4 : 0x5), in.target}); // je / jne
+                break;
+            case OP_JUMP:
+                fixups.push_back({e.jmp(), in.target});
+                break;
+            case OP_JCMP:
+                load(RAX, in.a);
+                load(RCX, in.b);
+                e.cmpRegReg(RAX, RCX);
+                fixups.push_back({e.jcc(condCode(in.rel)), in.target});
+                break;
+        }
+    }
+
+    // 4. 函数出口: 常驻寄存器的变量写回 env
+    offset[n] = e.buf.size();
+    for (int slot : regSlots) e.movEnvReg(slot, regOf[slot]);
+#if defined(_WIN32)
+    e.byte(0x5F);              // pop rdi
+#endif
+    e.byte(0xC3);              // ret
+
+    for (const auto& f : fixups) e.patchRel32(f.first, offset[f.second]);
+
+    // 5. 复制到可执行内存 (先可写，写完后改为只读可执行)
+    size = e.buf.size();
+#if defined(_WIN32)
+    mem = (unsigned char*)VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (!mem)
+    {
+        err = "VirtualAlloc 失败";
+        return false;
+    }
+    memcpy(mem, e.buf.data(), size);
+    DWORD oldProtect;
+    if (!VirtualProtect(mem, size, PAGE_EXECUTE_READ, &oldProtect))
+    {
+        err = "VirtualProtect 失败";
+        release();
+        return false;
+    }
+#else
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        err = "mmap 失败";
+        return false;
+    }
+    mem = (unsigned char*)p;
+    memcpy(mem, e.buf.data(), size);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        err = "mprotect 失败";
+        release();
+        return false;
+    }
+#endif
+    return true;
+#endif
+}
+
+bool NativeCode::run(vector<long long>& env)
+{
+    if (!mem) return false;
+    typedef void (*Entry)(long long*);
+    Entry f = (Entry)mem;
+    f(env.data());
+    return true;
+}
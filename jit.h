@@ -0,0 +1,54 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "common.h"
+#include "executor.h"
+
+/**
+ * @brief x86-64 本地代码后端
+ *
+ * 把 LoweredProgram 直接翻译为机器码，放入 mmap (Windows 为 VirtualAlloc) 得到的可执行内存中，
+ * 生成的函数原型为 void f(long long* env)，可在进程内直接调用。
+ *
+ * 变量映射:
+ * - 引用次数最多的若干变量常驻寄存器 r8~r11，函数入口从 env 读入，出口写回
+ * - 其余变量使用 env 数组中的槽位 [env + 8*slot]
+ * - rax, rcx 作为运算的临时寄存器
+ */
+class NativeCode
+{
+    unsigned char* mem; // 可执行内存
+    size_t size;        // 分配的字节数
+
+    /**
+     * @brief 释放可执行内存 (没有时什么也不做)
+     */
+    void release();
+
+public:
+    NativeCode();
+    ~NativeCode();
+    NativeCode(const NativeCode&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+
+    /**
+     * @brief 当前平台是否支持本地代码后端
+     */
+    static bool supported();
+
+    /**
+     * @brief 生成机器码 (再次调用时先释放上一次生成的代码)
+     * @param err 失败时写入错误原因
+     * @return 成功返回 true
+     */
+    bool compile(const LoweredProgram& prog, string& err);
+
+    /**
+     * @brief 执行生成的代码
+     * @param env 变量环境，大小不小于槽位个数
+     * @return 没有成功生成的代码时不执行，返回 false
+     */
+    bool run(vector<long long>& env);
+};
+
+#endif
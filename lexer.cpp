@@ -1,107 +1,238 @@
 #include "lexer.h"
 #include <cctype>
+#include <cassert>
 
 // 构造函数初始化
-Lexer::Lexer(string s) : input(s), pos(0) {}
+Lexer::Lexer(string_view s, const LexTable* lexTable) : input(s), pos(0), dropped(0), eof(true), table(lexTable) 
+{
+    if (table && !table->ready) table = nullptr;
+}
+
+Lexer::Lexer(const LexTable* lexTable) : pos(0), dropped(0), eof(false), table(lexTable) 
+{
+    if (table && !table->ready) table = nullptr;
+}
+
+void Lexer::feed(const string& chunk) 
+{
+    // 丢弃已经识别过的前缀，缓冲区中只剩下未完成的 Token
+    buffer.erase(0, pos);
+    dropped += pos;
+    pos = 0;
+    buffer += chunk;
+    input = buffer;
+}
+
+void Lexer::finish() 
+{
+    eof = true;
+}
+
+size_t Lexer::offset() const 
+{
+    return dropped + pos;
+}
+
+bool Lexer::tryNext(Token& tok) 
+{
+    if (table) return tryNextTable(tok);
+
+    // 1. 跳过空白字符 (空格, Tab, 换行)
+    while (pos < input.length() && isspace(input[pos])) 
+        pos++;
+    // 已到达数据末尾: 输入结束则返回结束符 Token，否则等待更多输入
+    if (pos >= input.length()) 
+    {
+        if (!eof) return false;
+        tok = {"#", "#"};
+        return true;
+    }
+    
+    size_t start = pos;
+    Token t = scan();
+    if (!eof && pos >= input.length()) 
+    {
+        pos = start;
+        return false;
+    }
+    lastType = t.type;
+    tok = t;
+    return true;
+}
 
 /**
- * @brief 将输入字符串分解为 Token 列表
- * 完善后的词法分析器，支持：
- * 1. 关键字 (while, if, else, int, float, return)
- * 2. 标识符 (id)
- * 3. 数字 (num): 支持整数、小数、正负数
- * 4. 运算符: +, -, *, /, =, >, <, >=, <=, ==, !=
- * 5. 界符: (, ), {, }, ;
+ * @brief 从输入中识别下一个 Token
+ * 只用于整体输入或 finish() 之后的流式输入，此时总能读到一个 Token；
+ * 流式输入尚未结束时应使用 tryNext()，否则返回类型为空的 Token (不会被当作结束符)
  */
-vector<Token> Lexer::tokenize() 
+Token Lexer::next() 
 {
-    vector<Token> tokens;
-    while (pos < input.length()) 
+    assert(eof);
+    Token tok;
+    if (!tryNext(tok)) 
+        tok = {"", ""};
+    return tok;
+}
+
+/**
+ * @brief 从当前位置识别一个 Token (调用前已跳过空白且未到达末尾)
+ */
+Token Lexer::scan() 
+{
+    char c = input[pos];
+    
+    // 2. 处理字母开头的单词 (关键字或标识符)
+    if (isalpha(c) || c == '_') 
     {
-        // 1. 跳过空白字符 (空格, Tab, 换行)
-        while (pos < input.length() && isspace(input[pos])) 
-            pos++;
-        if (pos >= input.length()) 
-            break;
+        string s;
+        // 读取完整的单词 (字母、数字、下划线)
+        while (pos < input.length() && (isalnum(input[pos]) || input[pos] == '_')) 
+            s += input[pos++];
         
-        char c = input[pos];
-        
-        // 2. 处理字母开头的单词 (关键字或标识符)
-        if (isalpha(c) || c == '_') 
-        {
-            string s;
-            // 读取完整的单词 (字母、数字、下划线)
-            while (pos < input.length() && (isalnum(input[pos]) || input[pos] == '_')) 
-                s += input[pos++];
-            
-            // 区分关键字和普通标识符
-            if (s == "while") tokens.push_back({"while", "while"});
-            else if (s == "if") tokens.push_back({"if", "if"});
-            else if (s == "else") tokens.push_back({"else", "else"});
-            else if (s == "int") tokens.push_back({"int", "int"});
-            else if (s == "float") tokens.push_back({"float", "float"});
-            else if (s == "return") tokens.push_back({"return", "return"});
-            else tokens.push_back({"id", s});
-        } 
-        // 3. 处理数字 (整数、小数、正负数)
-        // 判断是否为数字开头，或者是正负号开头且后面跟着数字（且前一个token不是id/num/右括号，表示是前缀符号）
-        else if (isdigit(c) || ((c == '+' || c == '-') && pos + 1 < input.length() && isdigit(input[pos+1]))) 
-        {
-            // 简单的上下文判断：如果前一个token是id、num、)或}，那么+ -应该是运算符而不是符号位
-            bool isSign = false;
-            if (c == '+' || c == '-') {
-                if (!tokens.empty()) {
-                    string lastType = tokens.back().type;
-                    if (lastType == "id" || lastType == "num" || lastType == ")" || lastType == "}") {
-                        isSign = false;
-                    } else {
-                        isSign = true;
-                    }
+        // 区分关键字和普通标识符
+        if (s == "while") return {"while", "while"};
+        else if (s == "if") return {"if", "if"};
+        else if (s == "else") return {"else", "else"};
+        else if (s == "int") return {"int", "int"};
+        else if (s == "float") return {"float", "float"};
+        else if (s == "return") return {"return", "return"};
+        else return {"id", s};
+    } 
+    // 3. 处理数字 (整数、小数、正负数)
+    // 判断是否为数字开头，或者是正负号开头且后面跟着数字（且前一个token不是id/num/右括号，表示是前缀符号）
+    else if (isdigit(c) || ((c == '+' || c == '-') && pos + 1 < input.length() && isdigit(input[pos+1]))) 
+    {
+        // 简单的上下文判断：如果前一个token是id、num、)或}，那么+ -应该是运算符而不是符号位
+        bool isSign = false;
+        if (c == '+' || c == '-') {
+            if (!lastType.empty()) {
+                if (lastType == "id" || lastType == "num" || lastType == ")" || lastType == "}") {
+                    isSign = false;
                 } else {
-                    isSign = true; // 第一个token
+                    isSign = true;
                 }
+            } else {
+                isSign = true; // 第一个token
             }
+        }
 
-            if (isSign || isdigit(c)) {
-                string s;
-                if (isSign) s += input[pos++]; // 吃掉符号
-                
-                bool hasDot = false;
-                while (pos < input.length() && (isdigit(input[pos]) || input[pos] == '.')) {
-                    if (input[pos] == '.') {
-                        if (hasDot) break; // 已经有一个小数点了
-                        hasDot = true;
-                    }
-                    s += input[pos++];
+        if (isSign || isdigit(c)) {
+            string s;
+            if (isSign) s += input[pos++]; // 吃掉符号
+            
+            bool hasDot = false;
+            while (pos < input.length() && (isdigit(input[pos]) || input[pos] == '.')) {
+                if (input[pos] == '.') {
+                    if (hasDot) break; // 已经有一个小数点了
+                    hasDot = true;
                 }
-                tokens.push_back({"num", s}); 
-            } else {
-                // 是运算符 + 或 -
-                string s(1, c);
-                tokens.push_back({s, s});
-                pos++;
+                s += input[pos++];
             }
-        } 
-        
-        // 4. 处理符号 (运算符和界符)
-        else 
-        {
+            return {"num", s}; 
+        } else {
+            // 是运算符 + 或 -
             string s(1, c);
-            // 预读下一个字符，处理双字符运算符
-            if (pos + 1 < input.length()) {
-                char next = input[pos+1];
-                if (c == '>' && next == '=') { s = ">="; pos++; }
-                else if (c == '<' && next == '=') { s = "<="; pos++; }
-                else if (c == '=' && next == '=') { s = "=="; pos++; }
-                else if (c == '!' && next == '=') { s = "!="; pos++; }
-            }
-            
-            // 将该字符(或字符串)转化为Token
-            tokens.push_back({s, s});
             pos++;
+            return {s, s};
+        }
+    } 
+    
+    // 4. 处理符号 (运算符和界符)
+    string s(1, c);
+    // 预读下一个字符，处理双字符运算符
+    if (pos + 1 < input.length()) {
+        char next = input[pos+1];
+        if (c == '>' && next == '=') { s = ">="; pos++; }
+        else if (c == '<' && next == '=') { s = "<="; pos++; }
+        else if (c == '=' && next == '=') { s = "=="; pos++; }
+        else if (c == '!' && next == '=') { s = "!="; pos++; }
+    }
+    
+    // 将该字符(或字符串)转化为Token
+    pos++;
+    return {s, s};
+}
+
+int Lexer::scanTable(Token& tok, bool& alive) 
+{
+    const unsigned char* cls = table->byteClass;
+    const int* next = table->next.data();
+    const int* accept = table->accept.data();
+    const int numClasses = table->numClasses;
+    const char* data = input.data();
+    size_t n = input.length();
+
+    // 每个字节查一次转移表，记录最后经过的接受状态
+    int s = 1, tokId = -1;
+    size_t end = pos, p = pos;
+    for (; p < n; ++p) 
+    {
+        s = next[s * numClasses + cls[(unsigned char)data[p]]];
+        if (s == 0) break;
+        if (accept[s] >= 0) 
+        {
+            tokId = accept[s];
+            end = p + 1;
+        }
+    }
+    alive = (p == n);
+
+    if (tokId < 0) 
+    {
+        // 没有任何定义匹配: 与手写规则一样返回单个字符，由语法分析器报错
+        tok.type = tok.value = string(1, input[pos]);
+        pos++;
+        return -1;
+    }
+    const TokenDef& d = table->tokens[tokId];
+    tok.value = string(input.substr(pos, end - pos));
+    tok.type = d.literal ? tok.value : d.name;
+    pos = end;
+    return tokId;
+}
+
+bool Lexer::tryNextTable(Token& tok) 
+{
+    while (true) 
+    {
+        if (pos >= input.length()) 
+        {
+            if (!eof) return false;
+            tok = {"#", "#"};
+            return true;
+        }
+        size_t start = pos;
+        Token t;
+        bool alive;
+        int id = scanTable(t, alive);
+        if (!eof && alive) 
+        {
+            pos = start;
+            return false;
         }
+        if (id >= 0 && table->tokens[id].skip) continue;
+        tok = move(t);
+        return true;
+    }
+}
+
+/**
+ * @brief 将输入字符串分解为 Token 列表
+ * 完善后的词法分析器，支持：
+ * 1. 关键字 (while, if, else, int, float, return)
+ * 2. 标识符 (id)
+ * 3. 数字 (num): 支持整数、小数、正负数
+ * 4. 运算符: +, -, *, /, =, >, <, >=, <=, ==, !=
+ * 5. 界符: (, ), {, }, ;
+ */
+vector<Token> Lexer::tokenize() 
+{
+    vector<Token> tokens;
+    while (true) 
+    {
+        tokens.push_back(next());
+        // 结束符 Token 表示输入结束 (类型为空表示流式输入尚未结束，见 next())
+        if (tokens.back().type == "#" || tokens.back().type.empty()) break;
     }
-    // 添加结束符 Token，表示输入结束
-    tokens.push_back({"#", "#"}); 
     return tokens;
 }
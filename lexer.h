@@ -2,28 +2,85 @@
 #define LEXER_H
 
 #include "common.h"
+#include "lexgen.h"
+#include <string_view>
 
 /**
  * @brief 词法分析器类
  * 负责将源代码字符串转换为 Token 序列
+ * 给出由文法文件生成的词法分析表时按表扫描，否则使用手写的识别规则
  */
 class Lexer 
 {
-    string input; // 输入的源代码字符串
-    int pos;      // 当前扫描到的字符位置
+    string buffer;     // 流式输入时缓存的字节 (只保留尚未识别的部分)
+    string_view input; // 正在扫描的字节: 整体输入时为构造时给出的源代码 (不复制)，流式输入时为 buffer
+    size_t pos;        // 当前扫描到的字符位置
+    size_t dropped;  // 流式输入时已从 input 中丢弃的字节数
+    string lastType; // 上一个 Token 的类型，用于区分正负号与加减运算符
+    bool eof;        // 输入是否已经全部到达
+    const LexTable* table; // 生成的词法分析表，为空 (或未生成) 时使用手写规则
+
+    Token scan();
+
+    /**
+     * @brief 按词法分析表识别一个 Token (最长匹配)
+     * @param tok 识别出的 Token，没有任何定义匹配时为单个字符
+     * @param alive 扫描到数据末尾时 DFA 仍未进入死状态 (流式输入时 Token 可能被后续字节延长)
+     * @return Token 定义的下标，没有匹配时返回 -1
+     */
+    int scanTable(Token& tok, bool& alive);
+
+    bool tryNextTable(Token& tok);
 
 public:
     /**
      * @brief 构造函数
-     * @param s 源代码字符串
+     * @param s 源代码，不复制，须在词法分析期间保持有效
+     * @param lexTable 生成的词法分析表 (可为空)
+     */
+    Lexer(string_view s, const LexTable* lexTable = nullptr);
+
+    /**
+     * @brief 构造流式词法分析器，输入通过 feed() 分块送入，最后调用 finish()
+     * @param lexTable 生成的词法分析表 (可为空)
+     */
+    Lexer(const LexTable* lexTable = nullptr);
+
+    /**
+     * @brief 流式输入: 追加一块字节 (已识别的部分会被丢弃，不缓存整个输入)
      */
-    Lexer(string s);
+    void feed(const string& chunk);
 
     /**
-     * @brief 执行词法分析
+     * @brief 流式输入: 标记输入结束
+     */
+    void finish();
+
+    /**
+     * @brief 尝试读取下一个完整的 Token
+     * 流式输入尚未结束时，若 Token 一直延伸到已到达数据的末尾 (可能被后续字节延长)，则不读取
+     * @param tok 读取到的 Token
+     * @return 需要更多输入时返回 false
+     */
+    bool tryNext(Token& tok);
+
+    /**
+     * @brief 最近读取的 Token 之后的位置 (从输入开头算起的字节数，包括流式输入已丢弃的部分)
+     */
+    size_t offset() const;
+
+    /**
+     * @brief 执行词法分析 (整体输入，或流式输入 finish() 之后)
      * @return 解析出的 Token 向量
      */
     vector<Token> tokenize();
+
+    /**
+     * @brief 按需读取下一个 Token (整体输入，或流式输入 finish() 之后)
+     * @return 下一个 Token，输入结束后总是返回结束符 {"#", "#"}；
+     *         流式输入尚未结束时不能调用 (调试版本断言失败，否则返回类型为空的 Token，而不是结束符)
+     */
+    Token next();
 };
 
 #endif
@@ -0,0 +1,424 @@
+#include "lexgen.h"
+#include <bitset>
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    // Thompson NFA 的状态: 至多一条字符集转移，外加若干 epsilon 转移
+    struct NfaState
+    {
+        bitset<256> chars;  // 字符集转移接受的字节
+        int to = -1;        // 字符集转移的目标，-1 表示没有
+        vector<int> eps;    // epsilon 转移的目标
+        int accept = -1;    // 接受的 Token 下标
+    };
+
+    // NFA 片段: 唯一的入口与出口
+    struct Frag
+    {
+        int start, end;
+    };
+
+    /**
+     * @brief 递归下降的正则表达式解析器，边解析边构造 NFA 片段
+     * alt    -> concat ('|' concat)*
+     * concat -> repeat*
+     * repeat -> atom ('*' | '+' | '?')*
+     */
+    class RegexParser
+    {
+        vector<NfaState>& nfa;
+        const string& re;
+        size_t pos;
+        string& err;
+
+        int add()
+        {
+            nfa.push_back(NfaState());
+            return nfa.size() - 1;
+        }
+        void eps(int from, int to) { nfa[from].eps.push_back(to); }
+
+        bool fail(const string& msg)
+        {
+            err = "正则表达式 " + re + " 第 " + to_string(pos) + " 个字符: " + msg;
+            return false;
+        }
+
+        // 转义序列: \n \t \r \d \w \s，其余字符表示其本身
+        bitset<256> escape(char c)
+        {
+            bitset<256> cs;
+            if (c == 'n') cs.set('\n');
+            else if (c == 't') cs.set('\t');
+            else if (c == 'r') cs.set('\r');
+            else if (c == 'd') { for (int b = '0'; b <= '9'; ++b) cs.set(b); }
+            else if (c == 's') { cs.set(' '); cs.set('\t'); cs.set('\n'); cs.set('\r'); cs.set('\f'); cs.set('\v'); }
+            else if (c == 'w')
+            {
+                for (int b = 0; b < 256; ++b)
+                    if (isalnum(b) || b == '_') cs.set(b);
+            }
+            else cs.set((unsigned char)c);
+            return cs;
+        }
+
+        bool parseClass(bitset<256>& cs)
+        {
+            bool negate = pos < re.size() && re[pos] == '^';
+            if (negate) pos++;
+            bool first = true;
+            while (pos < re.size() && (re[pos] != ']' || first))
+            {
+                first = false;
+                if (re[pos] == '\\' && pos + 1 < re.size())
+                {
+                    cs |= escape(re[pos + 1]);
+                    pos += 2;
+                    continue;
+                }
+                unsigned char lo = re[pos++];
+                if (pos + 1 < re.size() && re[pos] == '-' && re[pos + 1] != ']')
+                {
+                    unsigned char hi = re[pos + 1];
+                    pos += 2;
+                    if (hi < lo) return fail("字符范围颠倒");
+                    for (int b = lo; b <= hi; ++b) cs.set(b);
+                }
+                else cs.set(lo);
+            }
+            if (pos >= re.size()) return fail("缺少 ]");
+            pos++;
+            if (negate) cs.flip();
+            return true;
+        }
+
+        bool parseAtom(Frag& f)
+        {
+            char c = re[pos++];
+            bitset<256> cs;
+            if (c == '(')
+            {
+                if (!parseAlt(f)) return false;
+                if (pos >= re.size() || re[pos] != ')') return fail("缺少 )");
+                pos++;
+                return true;
+            }
+            if (c == '[')
+            {
+                if (!parseClass(cs)) return false;
+            }
+            else if (c == '.')
+            {
+                cs.set();
+                cs.reset('\n');
+            }
+            else if (c == '\\')
+            {
+                if (pos >= re.size()) return fail("末尾的 \\");
+                cs = escape(re[pos++]);
+            }
+            else if (c == '*' || c == '+' || c == '?' || c == ')' || c == '|')
+            {
+                pos--;
+                return fail(string("意外的 ") + c);
+            }
+            else cs.set((unsigned char)c);
+            f = charSet(cs);
+            return true;
+        }
+
+        bool parseRepeat(Frag& f)
+        {
+            if (!parseAtom(f)) return false;
+            while (pos < re.size() && (re[pos] == '*' || re[pos] == '+' || re[pos] == '?'))
+            {
+                char op = re[pos++];
+                int s = add(), e = add();
+                eps(s, f.start);
+                eps(f.end, e);
+                if (op != '+') eps(s, e);       // * 和 ? 可以跳过
+                if (op != '?') eps(f.end, f.start); // * 和 + 可以重复
+                f = {s, e};
+            }
+            return true;
+        }
+
+        bool parseConcat(Frag& f)
+        {
+            f = empty();
+            while (pos < re.size() && re[pos] != '|' && re[pos] != ')')
+            {
+                Frag next;
+                if (!parseRepeat(next)) return false;
+                eps(f.end, next.start);
+                f.end = next.end;
+            }
+            return true;
+        }
+
+    public:
+        RegexParser(vector<NfaState>& n, const string& r, string& e) : nfa(n), re(r), pos(0), err(e) {}
+
+        Frag charSet(const bitset<256>& cs)
+        {
+            int s = add(), e = add();
+            nfa[s].chars = cs;
+            nfa[s].to = e;
+            return {s, e};
+        }
+
+        Frag empty()
+        {
+            int s = add(), e = add();
+            eps(s, e);
+            return {s, e};
+        }
+
+        bool parseAlt(Frag& f)
+        {
+            if (!parseConcat(f)) return false;
+            while (pos < re.size() && re[pos] == '|')
+            {
+                pos++;
+                Frag other;
+                if (!parseConcat(other)) return false;
+                int s = add(), e = add();
+                eps(s, f.start);
+                eps(s, other.start);
+                eps(f.end, e);
+                eps(other.end, e);
+                f = {s, e};
+            }
+            return true;
+        }
+
+        bool parse(Frag& f)
+        {
+            if (!parseAlt(f)) return false;
+            if (pos < re.size()) return fail("多余的 )");
+            return true;
+        }
+    };
+}
+
+bool buildLexTable(const vector<TokenDef>& defs, LexTable& table, string& err)
+{
+    table = LexTable();
+
+    // 1. 每个定义构造一个 NFA 片段，由公共的初始状态经 epsilon 转移进入
+    vector<NfaState> nfa(1);
+    for (size_t t = 0; t < defs.size(); ++t)
+    {
+        RegexParser rp(nfa, defs[t].pattern, err);
+        Frag f;
+        if (defs[t].literal)
+        {
+            if (defs[t].pattern.empty())
+            {
+                err = "空的字面量";
+                return false;
+            }
+            f = rp.empty();
+            for (unsigned char c : defs[t].pattern)
+            {
+                bitset<256> cs;
+                cs.set(c);
+                Frag ch = rp.charSet(cs);
+                nfa[f.end].eps.push_back(ch.start);
+                f.end = ch.end;
+            }
+        }
+        else if (!rp.parse(f))
+        {
+            return false;
+        }
+        nfa[0].eps.push_back(f.start);
+        nfa[f.end].accept = t;
+    }
+
+    // 2. 字节等价类: 对每条转移的字符集做划分细化，同一类中的字节在所有转移上表现相同
+    vector<int> cls(256, 0);
+    int numCls = 1;
+    for (const auto& st : nfa)
+    {
+        if (st.to < 0) continue;
+        map<pair<int, bool>, int> remap;
+        for (int b = 0; b < 256; ++b)
+        {
+            auto key = make_pair(cls[b], (bool)st.chars[b]);
+            auto it = remap.find(key);
+            if (it == remap.end()) it = remap.insert({key, (int)remap.size()}).first;
+            cls[b] = it->second;
+        }
+        numCls = remap.size();
+    }
+    vector<int> rep(numCls, -1); // 每个等价类的代表字节
+    for (int b = 0; b < 256; ++b)
+        if (rep[cls[b]] < 0) rep[cls[b]] = b;
+
+    // 3. 子集构造: DFA 状态 0 为空集 (死状态)，状态 1 为初始状态的 epsilon 闭包
+    vector<int> mark(nfa.size(), -1);
+    int stamp = 0;
+    auto closure = [&](vector<int> items) -> vector<int> {
+        stamp++;
+        vector<int> stack = items;
+        for (int s : items) mark[s] = stamp;
+        while (!stack.empty())
+        {
+            int s = stack.back();
+            stack.pop_back();
+            for (int t : nfa[s].eps)
+            {
+                if (mark[t] == stamp) continue;
+                mark[t] = stamp;
+                items.push_back(t);
+                stack.push_back(t);
+            }
+        }
+        sort(items.begin(), items.end());
+        return items;
+    };
+
+    map<vector<int>, int> ids;
+    vector<vector<int>> sets;
+    auto idOf = [&](const vector<int>& items) -> int {
+        auto it = ids.find(items);
+        if (it != ids.end()) return it->second;
+        ids[items] = sets.size();
+        sets.push_back(items);
+        return sets.size() - 1;
+    };
+    idOf({});
+    idOf(closure({0}));
+
+    vector<vector<int>> dtrans;
+    for (size_t d = 0; d < sets.size(); ++d)
+    {
+        vector<int> row(numCls);
+        for (int c = 0; c < numCls; ++c)
+        {
+            vector<int> moved;
+            for (int s : sets[d])
+                if (nfa[s].to >= 0 && nfa[s].chars[rep[c]]) moved.push_back(nfa[s].to);
+            row[c] = moved.empty() ? 0 : idOf(closure(moved));
+        }
+        dtrans.push_back(row);
+    }
+    int n = sets.size();
+    vector<int> dAccept(n, -1);
+    for (int d = 0; d < n; ++d)
+    {
+        for (int s : sets[d])
+        {
+            int a = nfa[s].accept;
+            if (a >= 0 && (dAccept[d] < 0 || a < dAccept[d])) dAccept[d] = a;
+        }
+    }
+
+    // 4. 最小化: 按接受的 Token 初始划分，按 (所在块, 各等价类转移到的块) 反复细化直到不再变化
+    vector<int> block(n);
+    for (int d = 0; d < n; ++d) block[d] = dAccept[d] + 1;
+    int numBlocks = 0;
+    while (true)
+    {
+        map<vector<int>, int> sig;
+        vector<int> nb(n);
+        for (int d = 0; d < n; ++d)
+        {
+            vector<int> key(1, block[d]);
+            for (int c = 0; c < numCls; ++c) key.push_back(block[dtrans[d][c]]);
+            auto it = sig.find(key);
+            if (it == sig.end()) it = sig.insert({key, (int)sig.size()}).first;
+            nb[d] = it->second;
+        }
+        block = nb;
+        if ((int)sig.size() == numBlocks) break;
+        numBlocks = sig.size();
+    }
+    if (block[1] == block[0])
+    {
+        err = "Token 定义不能匹配任何输入";
+        return false;
+    }
+
+    // 重新编号: 死状态所在块为 0，初始状态所在块为 1
+    vector<int> newId(numBlocks, -1);
+    newId[block[0]] = 0;
+    newId[block[1]] = 1;
+    int next = 2;
+    for (int d = 0; d < n; ++d)
+        if (newId[block[d]] < 0) newId[block[d]] = next++;
+
+    // 5. 合并在最小 DFA 上完全相同的列，得到最终的等价类
+    vector<vector<int>> column(numCls, vector<int>(numBlocks));
+    vector<int> minAccept(numBlocks, -1);
+    for (int d = 0; d < n; ++d)
+    {
+        int b = newId[block[d]];
+        minAccept[b] = dAccept[d];
+        for (int c = 0; c < numCls; ++c) column[c][b] = newId[block[dtrans[d][c]]];
+    }
+    map<vector<int>, int> colId;
+    vector<int> finalCls(numCls);
+    for (int c = 0; c < numCls; ++c)
+    {
+        auto it = colId.find(column[c]);
+        if (it == colId.end()) it = colId.insert({column[c], (int)colId.size()}).first;
+        finalCls[c] = it->second;
+    }
+
+    table.numStates = numBlocks;
+    table.numClasses = colId.size();
+    for (int b = 0; b < 256; ++b) table.byteClass[b] = finalCls[cls[b]];
+    table.next.assign(table.numStates * table.numClasses, 0);
+    for (int c = 0; c < numCls; ++c)
+        for (int s = 0; s < numBlocks; ++s)
+            table.next[s * table.numClasses + finalCls[c]] = column[c][s];
+    table.accept = minAccept;
+    table.tokens = defs;
+    table.ready = true;
+    return true;
+}
+
+void printLexTable(const LexTable& table)
+{
+    cout << "词法分析表: " << table.numStates << " 个状态，" << table.numClasses << " 个字节等价类" << endl;
+
+    // 等价类: 列出每类中的可打印字符
+    for (int c = 0; c < table.numClasses; ++c)
+    {
+        string chars;
+        int others = 0;
+        for (int b = 0; b < 256; ++b)
+        {
+            if (table.byteClass[b] != c) continue;
+            if (b > ' ' && b < 127) chars += (char)b;
+            else others++;
+        }
+        cout << "类" << c << ": " << chars;
+        if (others) cout << (chars.empty() ? "" : " ") << "(另有 " << others << " 个不可见字节)";
+        cout << endl;
+    }
+
+    cout << "状态";
+    for (int c = 0; c < table.numClasses; ++c) cout << "\t类" << c;
+    cout << "\t接受" << endl;
+    for (int s = 0; s < table.numStates; ++s)
+    {
+        cout << s;
+        for (int c = 0; c < table.numClasses; ++c)
+        {
+            int t = table.next[s * table.numClasses + c];
+            cout << "\t" << (t ? to_string(t) : "");
+        }
+        int a = table.accept[s];
+        if (a >= 0)
+        {
+            const TokenDef& d = table.tokens[a];
+            cout << "\t" << (d.skip ? "(跳过)" : d.name);
+        }
+        cout << endl;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef LEXGEN_H
+#define LEXGEN_H
+
+#include "common.h"
+
+/**
+ * @brief 一条词法单元定义
+ */
+struct TokenDef 
+{
+    string name;    // Token 类型名 (即文法中的终结符)，跳过的模式为空串
+    string pattern; // 正则表达式，literal 为 true 时为原样匹配的字符串
+    bool literal;   // 是否为字面量 (文法中直接出现的关键字、运算符、界符)
+    bool skip;      // 匹配后丢弃 (空白、注释)
+};
+
+/**
+ * @brief 生成的词法分析表
+ *
+ * 字节先经 byteClass 映射为等价类，状态转移表按行优先存放:
+ *   next[状态 * numClasses + 等价类]
+ * 状态 0 为死状态，状态 1 为初始状态；accept[状态] 为在该状态结束时识别出的 Token 下标，-1 表示非接受状态。
+ * 扫描时每个字节只做一次查表，按最长匹配取最后一个接受状态
+ */
+struct LexTable 
+{
+    bool ready = false;             // 是否已经生成
+    int numStates = 0;              // 状态数 (含死状态)
+    int numClasses = 0;             // 字节等价类个数
+    unsigned char byteClass[256];   // 字节 -> 等价类
+    vector<int> next;               // 状态转移表
+    vector<int> accept;             // [状态] -> Token 下标
+    vector<TokenDef> tokens;        // [Token 下标] -> 定义
+};
+
+/**
+ * @brief 由 Token 定义生成词法分析表
+ * 过程: 正则表达式 -> Thompson NFA -> 划分字节等价类 -> 子集构造 DFA -> 划分细化最小化 -> 合并等价列
+ *
+ * 支持的正则语法: 字符、转义 (\n \t \r \\ 及对元字符的转义)、. (除换行外任意字节)、
+ * 字符类 [a-z_] 与 [^...]、分组 ( )、选择 |、重复 * + ?
+ *
+ * 多个定义同时匹配最长前缀时，取 defs 中靠前的一个 (字面量应排在正则定义之前，使关键字优先于标识符)
+ * @param err 失败时写入错误原因
+ * @return 成功返回 true
+ */
+bool buildLexTable(const vector<TokenDef>& defs, LexTable& table, string& err);
+
+/**
+ * @brief 打印词法分析表 (等价类与状态转移表)
+ */
+void printLexTable(const LexTable& table);
+
+#endif
@@ -1,6 +1,18 @@
+#include "memory.cpp"
+#include "lexgen.cpp"
+#include "embedded.cpp"
+#include "statestore.cpp"
 #include "grammar.cpp"
 #include "parser.cpp"
 #include "lexer.cpp"
+#include "optimizer.cpp"
+#include "executor.cpp"
+#include "jit.cpp"
+#include "benchmark.cpp"
+#include "cache.cpp"
+#include "pushparser.cpp"
+#include "parallel.cpp"
+#include "incremental.cpp"
 #include <iostream>
 #include <fstream>
 
@@ -14,14 +26,134 @@
  * 4. 初始化语法分析器 Parser
  * 5. 读取源代码文件 (source.txt)
  * 6. 执行语法分析并输出四元式
+ *
+ * 命令行选项:
+ *   --recycle-temps   对生成的四元式做活跃性分析，复用临时变量
+ *   --backpatch       使用回填方式生成条件跳转 (跳转目标为四元式序号)
+ *   --bench-native    对比 x86-64 本地代码与字节码解释执行的性能
+ *   --cache <目录>    经过编译结果缓存分析源代码，命中时跳过词法/语法分析
+ *   --grammar <文件>  指定文法文件 (默认 testfile.txt)
+ *   --unit-elim       构建分析表后消除无语义效果的单产生式归约
+ *   --bench-unit      在随机语料上统计单产生式归约消除减少的归约次数
+ *   --default-reduce  标记默认归约状态，这些状态不读向前看符号、不查表直接归约
+ *   --bench-default   在随机语料上统计默认归约减少的查表次数和表大小
+ *   --bench-profile   剖析训练语料后按访问频率重编号状态，对比缓存行占用和吞吐量
+ *   --stdin           从标准输入逐行读取源代码，用推式分析器边读边分析
+ *   --check-push      检查推式分析器在随机分块下与整体分析的结果一致
+ *   --check-temps     检查临时变量复用和循环优化不改写源程序中名为 Tn 的变量
+ *   --parallel <文件> 在顶层语句边界切分源文件并多线程分析 (需使用语句序列文法 testfile_seq.txt)
+ *   --threads <n>     并行分析的线程数 (默认使用硬件线程数)
+ *   --bench-parallel  对比大源文件上串行分析与并行分析的耗时
+ *   --mem-stats       打印构建与分析各阶段的内存使用情况 (峰值字节数、分配次数)
+ *   --dump-lexer      打印由 %token 定义生成的词法分析表
+ *   --bench-lexer     对比生成的词法分析器与手写词法分析器的结果和吞吐量
+ *   --opt-loops       对生成的循环做不变代码外提、归纳变量强度削弱和循环倒置
+ *   --dump-cfg        打印生成的四元式的基本块、控制流图和循环
+ *   --bench-loops     对比循环优化前后执行的指令条数
+ *   --embedded        使用编译期生成的内置文法分析表，启动时不构造分析表 (需以 -std=c++20 编译)
+ *   --check-embedded  检查编译期分析表与运行时构造的结果一致，并对比启动耗时
+ *   --lazy            惰性构建分析表: 状态的 Action/Goto 行在分析时第一次用到才计算
+ *   --bench-lazy      在追加了大量无关语句的大文法上对比惰性构建与立即构建的启动耗时和内存
+ *   --bench-incremental 对比源文件被修改后增量分析与整体重新分析的耗时，并检查结果一致
+ *   --stream          流式输出四元式: 每归约完一条顶层语句就输出其四元式，不等分析结束 (不做循环优化和临时变量复用)
+ *   --bench-stream    对比流式输出与接受时整体输出的耗时和峰值内存，并检查结果一致
  */
-int main() 
+int main(int argc, char* argv[]) 
 {
+    bool recycleTemps = false;
+    bool backpatch = false;
+    bool benchNative = false;
+    string cacheDir;
+    string grammarFile = "testfile.txt";
+    bool unitElim = false;
+    bool benchUnit = false;
+    bool defaultReduce = false;
+    bool benchDefault = false;
+    bool benchProfile = false;
+    bool fromStdin = false;
+    bool checkPush = false;
+    bool checkTemps = false;
+    string parallelFile;
+    int threads = 0;
+    bool benchParallel = false;
+    bool memStats = false;
+    bool dumpLexer = false;
+    bool benchLexer = false;
+    bool loopOpt = false;
+    bool dumpCfg = false;
+    bool benchLoops = false;
+    bool embedded = false;
+    bool checkEmbedded = false;
+    bool lazy = false;
+    bool benchLazy = false;
+    bool benchIncremental = false;
+    bool stream = false;
+    bool benchStream = false;
+    for (int i = 1; i < argc; ++i) 
+    {
+        string arg = argv[i];
+        if (arg == "--recycle-temps") recycleTemps = true;
+        else if (arg == "--backpatch") backpatch = true;
+        else if (arg == "--bench-native") benchNative = true;
+        else if (arg == "--cache" && i + 1 < argc) cacheDir = argv[++i];
+        else if (arg == "--grammar" && i + 1 < argc) grammarFile = argv[++i];
+        else if (arg == "--unit-elim") unitElim = true;
+        else if (arg == "--bench-unit") benchUnit = true;
+        else if (arg == "--default-reduce") defaultReduce = true;
+        else if (arg == "--bench-default") benchDefault = true;
+        else if (arg == "--bench-profile") benchProfile = true;
+        else if (arg == "--stdin") fromStdin = true;
+        else if (arg == "--check-push") checkPush = true;
+        else if (arg == "--check-temps") checkTemps = true;
+        else if (arg == "--parallel" && i + 1 < argc) parallelFile = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "--bench-parallel") benchParallel = true;
+        else if (arg == "--mem-stats") memStats = true;
+        else if (arg == "--dump-lexer") dumpLexer = true;
+        else if (arg == "--bench-lexer") benchLexer = true;
+        else if (arg == "--opt-loops") loopOpt = true;
+        else if (arg == "--dump-cfg") dumpCfg = true;
+        else if (arg == "--bench-loops") benchLoops = true;
+        else if (arg == "--embedded") embedded = true;
+        else if (arg == "--check-embedded") checkEmbedded = true;
+        else if (arg == "--lazy") lazy = true;
+        else if (arg == "--bench-lazy") benchLazy = true;
+        else if (arg == "--bench-incremental") benchIncremental = true;
+        else if (arg == "--stream") stream = true;
+        else if (arg == "--bench-stream") benchStream = true;
+    }
+
+    // 内存计数默认关闭，有额外开销，只在需要报告内存时打开
+    if (memStats) 
+        setMemoryTracking(true);
+
     GrammarAnalyzer G;
     
-    // 1. 读取testfile文件获取并加载文法G
-    // 文法文件格式: S -> while ( C ) { S }
-    G.loadGrammar("testfile.txt");
+    if (checkEmbedded) 
+    {
+        return checkEmbeddedTable() ? 0 : 1;
+    }
+    if (checkTemps) 
+    {
+        return checkUserTempNames() ? 0 : 1;
+    }
+    if (embedded) 
+    {
+        // 内置文法的分析表已在编译期生成，这里只装入
+        EmbeddedTableView view;
+        if (!embeddedGrammar(view)) 
+        {
+            cout << "没有编译期分析表，请以 -std=c++20 编译" << endl;
+            return 1;
+        }
+        G.loadEmbedded(view);
+    }
+    else 
+    {
+        // 1. 读取testfile文件获取并加载文法G
+        // 文法文件格式: S -> while ( C ) { S }
+        G.loadGrammar(grammarFile);
+    }
     
     //打印该文法
     cout << "文法加载:" << endl;
@@ -33,19 +165,188 @@ int main()
     
     // 2. 构建分析表
     // 如果存在冲突 (Shift-Reduce 或 Reduce-Reduce)，则构建失败
-    if (!G.build()) 
+    if (embedded) 
+    {
+        cout << "使用编译期生成的SLR(1)分析表" << endl;
+    }
+    else if (lazy) 
+    {
+        G.buildLazy();
+        cout << "惰性构建: 分析表的各行在分析时按需计算" << endl;
+    }
+    else if (!G.build()) 
     {
         cout << "该文法不是SLR(1)文法!" << endl;
         return 1;
     }
-    cout << "SLR(1)分析表成功构建!" << endl;
+    else 
+    {
+        cout << "SLR(1)分析表成功构建!" << endl;
+    }
     cout << "DFA状态集数量共有: " << G.states.size() << endl;
+    if (G.lexTable.ready) 
+    {
+        cout << "词法分析表由 " << G.lexTable.tokens.size() << " 条定义生成: " << G.lexTable.numStates
+             << " 个状态，" << G.lexTable.numClasses << " 个字节等价类" << endl;
+        if (dumpLexer) printLexTable(G.lexTable);
+    }
+    if ((embedded || lazy) && (unitElim || defaultReduce)) 
+    {
+        cout << (embedded ? "编译期" : "惰性构建的") << "分析表不支持单产生式归约消除和默认归约，已忽略" << endl;
+        unitElim = defaultReduce = false;
+    }
+    if (unitElim) 
+    {
+        cout << "单产生式归约消除: 改写表项 " << G.eliminateUnitReductions() << " 个" << endl;
+    }
+    if (defaultReduce) 
+    {
+        cout << "默认归约状态: " << G.markDefaultReductions() << " 个" << endl;
+    }
+    if (memStats) 
+    {
+        cout << "状态存储: " << G.states.size() << " 个状态，" << G.states.itemCount() << " 个核心项目，"
+             << G.states.transitionCount() << " 条转移，共 " << G.states.memoryBytes() << " B" << endl;
+    }
+    {
+        // 分析表已冻结，项目集与转移表不再需要
+        MemoryPhase phase("释放构建数据");
+        G.releaseBuildData();
+    }
     cout << "------------------------" << endl;
+
+    if (benchNative) 
+    {
+        benchmarkNative(G);
+        return 0;
+    }
+    if (benchUnit) 
+    {
+        benchmarkUnitElimination(grammarFile);
+        return 0;
+    }
+    if (benchDefault) 
+    {
+        benchmarkDefaultReductions(grammarFile);
+        return 0;
+    }
+    if (benchProfile) 
+    {
+        benchmarkProfileRenumber(grammarFile);
+        return 0;
+    }
+    if (benchLoops) 
+    {
+        benchmarkLoops();
+        return 0;
+    }
+    if (benchLazy) 
+    {
+        benchmarkLazy(grammarFile, 60);
+        return 0;
+    }
+    if (benchIncremental) 
+    {
+        benchmarkIncremental();
+        return 0;
+    }
+    if (benchStream) 
+    {
+        benchmarkStream();
+        return 0;
+    }
+    if (benchLexer) 
+    {
+        benchmarkLexer(grammarFile);
+        return 0;
+    }
+    if (benchParallel) 
+    {
+        benchmarkParallel(16);
+        return 0;
+    }
+    if (!parallelFile.empty()) 
+    {
+        ifstream in(parallelFile, ios::binary);
+        if (!in) 
+        {
+            cout << "无法打开源文件 " << parallelFile << endl;
+            return 1;
+        }
+        string src((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        ParallelParser pp(G, threads);
+        pp.recycleTemps = recycleTemps;
+        pp.backpatch = backpatch;
+        if (!pp.parse(src)) 
+        {
+            // 各线程的分析器是静默的，在这里统一报告
+            cout << "并行分析失败: 语法错误，在符号 " << pp.errorSymbol << " 处 (该符号结束于源文件第 " << pp.errorOffset << " 字节)" << endl;
+            return 1;
+        }
+        cout << "并行分析: " << pp.threads << " 线程，" << pp.chunks << " 块" << endl;
+        cout << "生成的四元式：" << endl;
+        for (size_t i = 0; i < pp.result.size(); ++i) 
+            cout << i + 1 << ": " << pp.result[i].toString() << endl;
+        return 0;
+    }
+    if (checkPush) 
+    {
+        return checkPushParser(G) ? 0 : 1;
+    }
+    if (stream && (recycleTemps || loopOpt || dumpCfg || !cacheDir.empty())) 
+    {
+        cout << "流式输出不保留完整的四元式序列，不支持循环优化、临时变量复用、控制流图和编译缓存，已忽略" << endl;
+        recycleTemps = loopOpt = dumpCfg = false;
+        cacheDir.clear();
+    }
+    if (fromStdin) 
+    {
+        // 每读到一行就送入推式分析器，不等待整个输入
+        PushParser pp(G);
+        pp.parser.recycleTemps = recycleTemps;
+        pp.parser.loopOpt = loopOpt;
+        pp.parser.backpatch = backpatch;
+        int line = 0;
+        if (stream) 
+        {
+            // 每条顶层语句归约完就输出，不等输入结束
+            pp.parser.sink = [&](const Quad& q) { cout << ++line << ": " << q.toString() << endl; };
+        }
+        string text;
+        while (pp.state() == PARSE_CONTINUE && getline(cin, text)) 
+            pp.feed(text + "\n");
+        if (pp.finish() != PARSE_ACCEPT) 
+        {
+            cout << "语法错误，在符号 " << pp.parser.errorSymbol << " 处" << endl;
+            return 1;
+        }
+        if (stream) return 0;
+        cout << "生成的四元式：" << endl;
+        for (size_t i = 0; i < pp.parser.result.size(); ++i) 
+            cout << i + 1 << ": " << pp.parser.result[i].toString() << endl;
+        return 0;
+    }
     
     // 3. 分析输入
     // 初始化语法分析器，传入构建好的文法分析器 G
     // 接下来使用配置好的SLR(1)分析表来解决语法问题，传入文法G到语法分析器parse中
     Parser parser(G);
+    parser.recycleTemps = recycleTemps;
+    parser.loopOpt = loopOpt;
+    parser.backpatch = backpatch;
+    ofstream streamFile;
+    int streamLine = 0;
+    if (stream) 
+    {
+        // 四元式一经确定就写入 output.txt 并打印，与分析过程交错出现
+        streamFile.open("output.txt");
+        parser.sink = [&](const Quad& q) 
+        {
+            string qStr = q.toString();
+            cout << "输出 " << ++streamLine << ": " << qStr << endl;
+            streamFile << streamLine << ": " << qStr << endl;
+        };
+    }
     
     // 测试用例备用：while ( a > b ) { x = y }
     // 使用嵌套语句进行测试
@@ -57,7 +358,7 @@ int main()
 
     // 词法分析展示
     cout << "词法分析展示:" << endl;
-    Lexer lexer(srcLine);
+    Lexer lexer(srcLine, &G.lexTable);
     vector<Token> tokens = lexer.tokenize();
     //打印一下获得的词法分析的Token
     for (const auto& t : tokens) 
@@ -67,7 +368,45 @@ int main()
     cout << endl << "------------------------" << endl;
 
     // 语法分析与语义分析
-    parser.parse(srcLine);
+    if (!cacheDir.empty()) 
+    {
+        CompileCache cache(G, cacheDir);
+        vector<Quad> code;
+        if (cache.compile(parser, srcLine, code) && cache.misses == 0) 
+        {
+            // 与未命中时 Parser::accept() 的输出一致，同样写入 output.txt
+            cout << "缓存命中，生成的四元式：" << endl;
+            ofstream outFile("output.txt");
+            for (size_t i = 0; i < code.size(); ++i) 
+            {
+                cout << i + 1 << ": " << code[i].toString() << endl;
+                outFile << i + 1 << ": " << code[i].toString() << endl;
+            }
+            cout << "四元式已保存到 output.txt" << endl;
+        }
+        cache.printStats();
+    }
+    else 
+    {
+        MemoryPhase phase("语法分析");
+        parser.parse(srcLine);
+    }
+    if (lazy) 
+    {
+        int rows = 0;
+        for (char r : G.rowReady) rows += r;
+        cout << "惰性构建: 已计算 " << rows << " 行，已创建 " << G.states.size() << " 个状态" << endl;
+    }
+    if (dumpCfg && !parser.result.empty()) 
+    {
+        cout << "------------------------" << endl;
+        printCFG(parser.result, buildCFG(parser.result));
+    }
+    if (memStats) 
+    {
+        cout << "------------------------" << endl;
+        printMemoryReport();
+    }
     
     system("pause");
     return 0;
@@ -0,0 +1,101 @@
+#include "memory.h"
+#include <cstdlib>
+#include <new>
+
+MemoryCounters& memoryCounters() 
+{
+    static MemoryCounters counters;
+    return counters;
+}
+
+// 计数开关，静态初始化为常量，早于任何动态分配
+static atomic<bool> trackingOn(false);
+
+void setMemoryTracking(bool on) 
+{
+    trackingOn.store(on, memory_order_relaxed);
+}
+
+bool memoryTracking() 
+{
+    return trackingOn.load(memory_order_relaxed);
+}
+
+// 每块内存前放一个 16 字节的头部记录大小，保持 new 返回地址的对齐
+// 未计数的块头部为 kUntracked，释放时不扣减
+static const size_t kHeader = 16;
+static const size_t kUntracked = ~(size_t)0;
+
+static void* trackedAlloc(size_t n) 
+{
+    void* raw = malloc(n + kHeader);
+    if (!raw) throw bad_alloc();
+    if (!trackingOn.load(memory_order_relaxed)) 
+    {
+        *static_cast<size_t*>(raw) = kUntracked;
+        return static_cast<char*>(raw) + kHeader;
+    }
+    *static_cast<size_t*>(raw) = n;
+
+    MemoryCounters& c = memoryCounters();
+    long long now = c.live.fetch_add(n, memory_order_relaxed) + n;
+    c.allocations.fetch_add(1, memory_order_relaxed);
+    c.totalBytes.fetch_add(n, memory_order_relaxed);
+    long long peak = c.peak.load(memory_order_relaxed);
+    while (now > peak && !c.peak.compare_exchange_weak(peak, now, memory_order_relaxed)) {}
+    return static_cast<char*>(raw) + kHeader;
+}
+
+static void trackedFree(void* p) 
+{
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - kHeader;
+    size_t n = *static_cast<size_t*>(raw);
+    if (n != kUntracked) 
+        memoryCounters().live.fetch_sub(n, memory_order_relaxed);
+    free(raw);
+}
+
+void* operator new(size_t n) { return trackedAlloc(n); }
+void* operator new[](size_t n) { return trackedAlloc(n); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+
+vector<PhaseMemory>& memoryReport() 
+{
+    static vector<PhaseMemory> report;
+    return report;
+}
+
+void printMemoryReport() 
+{
+    cout << "阶段\t\t分配次数\t累计分配(B)\t峰值增量(B)\t保留(B)" << endl;
+    for (const auto& p : memoryReport()) 
+    {
+        cout << p.name << "\t" << p.allocations << "\t\t" << p.bytes << "\t\t"
+             << p.peakBytes << "\t\t" << p.retained << endl;
+    }
+    cout << "进程峰值: " << memoryCounters().peak.load() << " B" << endl;
+}
+
+MemoryPhase::MemoryPhase(const string& phaseName) : name(phaseName) 
+{
+    MemoryCounters& c = memoryCounters();
+    startLive = c.live.load();
+    startAllocations = c.allocations.load();
+    startBytes = c.totalBytes.load();
+    savedPeak = c.peak.exchange(startLive);
+}
+
+MemoryPhase::~MemoryPhase() 
+{
+    MemoryCounters& c = memoryCounters();
+    long long peak = c.peak.load();
+    PhaseMemory p = {name, c.allocations.load() - startAllocations, c.totalBytes.load() - startBytes,
+                     peak - startLive, c.live.load() - startLive};
+    // 恢复进程级峰值
+    if (savedPeak > peak) c.peak.store(savedPeak);
+    memoryReport().push_back(p);
+}
@@ -0,0 +1,78 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "common.h"
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief 全局内存计数
+ * 由替换的全局 operator new/delete 维护，统计整个进程经由 new 分配的堆内存
+ * (包括 string、vector、set、map 等标准容器的节点)。
+ * 只在 setMemoryTracking(true) 之后计数，默认关闭: 关闭时每次分配只多读一个标志，
+ * 不修改进程共享的计数器，分析热路径和并行分析的各线程之间没有额外的原子操作和缓存行争用
+ */
+struct MemoryCounters 
+{
+    atomic<long long> live{0};        // 当前存活的字节数
+    atomic<long long> peak{0};        // 存活字节数的峰值
+    atomic<long long> allocations{0}; // 累计分配次数
+    atomic<long long> totalBytes{0};  // 累计分配的字节数
+};
+
+/**
+ * @brief 进程唯一的内存计数器
+ */
+MemoryCounters& memoryCounters();
+
+/**
+ * @brief 打开或关闭内存计数
+ * 打开之前分配的内存不计入，释放时也不扣减，计数始终只反映打开期间分配的内存
+ */
+void setMemoryTracking(bool on);
+
+/**
+ * @brief 内存计数是否打开
+ */
+bool memoryTracking();
+
+/**
+ * @brief 一个阶段的内存使用情况
+ */
+struct PhaseMemory 
+{
+    string name;           // 阶段名称
+    long long allocations; // 阶段内的分配次数
+    long long bytes;       // 阶段内累计分配的字节数
+    long long peakBytes;   // 阶段内存活字节数相对阶段开始时的最大增量
+    long long retained;    // 阶段结束时仍然存活的增量 (留给后续阶段使用的数据)
+};
+
+/**
+ * @brief 按时间顺序记录的各阶段内存使用情况
+ */
+vector<PhaseMemory>& memoryReport();
+
+/**
+ * @brief 打印 memoryReport() 中的各阶段统计
+ */
+void printMemoryReport();
+
+/**
+ * @brief 阶段计量 (RAII)
+ * 构造时记下当前计数并把峰值重置为当前存活量，析构时把本阶段的统计追加到 memoryReport()
+ * 阶段不应嵌套
+ */
+class MemoryPhase 
+{
+    string name;
+    long long startLive, startAllocations, startBytes, savedPeak;
+
+public:
+    MemoryPhase(const string& phaseName);
+    ~MemoryPhase();
+    MemoryPhase(const MemoryPhase&) = delete;
+    MemoryPhase& operator=(const MemoryPhase&) = delete;
+};
+
+#endif
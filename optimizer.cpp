@@ -0,0 +1,572 @@
+#include "optimizer.h"
+#include <cctype>
+#include <algorithm>
+
+bool isTempName(const string& s)
+{
+    if (s.size() < 3 || s[0] != kGeneratedMark || s[1] != 'T') return false;
+    for (size_t i = 2; i < s.size(); ++i)
+    {
+        if (!isdigit((unsigned char)s[i])) return false;
+    }
+    return true;
+}
+
+// 判断该四元式的 result 字段是否为跳转目标/标号而非定值变量
+// 跳转类: jump, jfalse，以及回填模式下的 j, j>, j<, j==
+static bool isControlQuad(const Quad& q)
+{
+    return q.op == "label" || (!q.op.empty() && q.op[0] == 'j');
+}
+
+// 无条件跳转
+static bool isUnconditionalJump(const Quad& q)
+{
+    return q.op == "jump" || q.op == "j";
+}
+
+TempRecycleStats renumberTemps(vector<Quad>& code)
+{
+    int n = code.size();
+
+    // 1. 给所有临时变量编号，并记录每条四元式的使用/定值
+    map<string, int> tempId;
+    vector<string> tempNames;
+    auto idOf = [&](const string& s) -> int {
+        if (!isTempName(s)) return -1;
+        auto it = tempId.find(s);
+        if (it != tempId.end()) return it->second;
+        tempId[s] = tempNames.size();
+        tempNames.push_back(s);
+        return tempNames.size() - 1;
+    };
+
+    vector<vector<int>> uses(n);
+    vector<int> defs(n, -1);
+    map<string, int> labelPos; // 标号 -> 所在四元式下标
+    for (int i = 0; i < n; ++i)
+    {
+        const Quad& q = code[i];
+        int u1 = idOf(q.arg1), u2 = idOf(q.arg2);
+        if (u1 >= 0) uses[i].push_back(u1);
+        if (u2 >= 0) uses[i].push_back(u2);
+        if (isControlQuad(q))
+        {
+            if (q.op == "label") labelPos[q.result] = i;
+        }
+        else
+        {
+            defs[i] = idOf(q.result);
+        }
+    }
+
+    // 2. 控制流后继: 无条件跳转只到目标，条件跳转到下一条和目标，其余顺序执行
+    //    目标为标号名 (普通模式) 或从 1 开始的四元式序号 (回填模式)
+    vector<vector<int>> succ(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const Quad& q = code[i];
+        if (!isUnconditionalJump(q) && i + 1 < n) succ[i].push_back(i + 1);
+        if (q.op == "label" || !isControlQuad(q)) continue;
+        if (labelPos.count(q.result))
+            succ[i].push_back(labelPos[q.result]);
+        else if (!q.result.empty() && isdigit((unsigned char)q.result[0]))
+        {
+            int target = stoi(q.result) - 1;
+            if (target < n) succ[i].push_back(target);
+        }
+    }
+
+    // 3. 反向迭代求活跃变量: in = use ∪ (out - def), out = ∪ in[后继]
+    vector<set<int>> liveIn(n), liveOut(n);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int i = n - 1; i >= 0; --i)
+        {
+            set<int> out;
+            for (int s : succ[i])
+                out.insert(liveIn[s].begin(), liveIn[s].end());
+
+            set<int> in = out;
+            if (defs[i] >= 0) in.erase(defs[i]);
+            in.insert(uses[i].begin(), uses[i].end());
+
+            if (out != liveOut[i] || in != liveIn[i])
+            {
+                liveOut[i] = out;
+                liveIn[i] = in;
+                changed = true;
+            }
+        }
+    }
+
+    // 4. 建立冲突关系: 定值点的变量与该点出口处其他活跃变量冲突
+    int tempTotal = tempNames.size();
+    vector<set<int>> conflicts(tempTotal);
+    TempRecycleStats stats = {tempTotal, 0, 0};
+    for (int i = 0; i < n; ++i)
+    {
+        int peak = max(liveIn[i].size(), liveOut[i].size());
+        if (peak > stats.peakLive) stats.peakLive = peak;
+
+        int d = defs[i];
+        if (d < 0) continue;
+        for (int t : liveOut[i])
+        {
+            if (t == d) continue;
+            conflicts[d].insert(t);
+            conflicts[t].insert(d);
+        }
+    }
+
+    // 5. 按编号(即首次出现的顺序)贪心着色，取冲突邻居未占用的最小槽位
+    vector<int> slot(tempTotal, -1);
+    for (int t = 0; t < tempTotal; ++t)
+    {
+        set<int> used;
+        for (int c : conflicts[t])
+        {
+            if (slot[c] >= 0) used.insert(slot[c]);
+        }
+        int s = 0;
+        while (used.count(s)) s++;
+        slot[t] = s;
+        if (s + 1 > stats.slots) stats.slots = s + 1;
+    }
+
+    // 6. 用槽位改写临时变量名: 去掉前缀后不能与源程序中名为 Tn 的变量同名，跳过这些编号
+    set<string> userNames;
+    for (const auto& q : code)
+    {
+        for (const string* s : {&q.arg1, &q.arg2, &q.result})
+        {
+            if (s->size() > 1 && (*s)[0] == 'T' && s->find_first_not_of("0123456789", 1) == string::npos)
+                userNames.insert(*s);
+        }
+    }
+    vector<string> slotName;
+    for (int k = 1; (int)slotName.size() < stats.slots; ++k)
+    {
+        if (!userNames.count("T" + to_string(k))) slotName.push_back(string(1, kGeneratedMark) + "T" + to_string(k));
+    }
+    auto rename = [&](string& s) {
+        auto it = tempId.find(s);
+        if (it != tempId.end()) s = slotName[slot[it->second]];
+    };
+    for (auto& q : code)
+    {
+        rename(q.arg1);
+        rename(q.arg2);
+        if (!isControlQuad(q)) rename(q.result);
+    }
+    return stats;
+}
+
+// 判断是否为数字常量 (可带正负号)
+static bool isConstant(const string& s)
+{
+    size_t i = (s.size() > 1 && (s[0] == '+' || s[0] == '-')) ? 1 : 0;
+    if (i >= s.size()) return false;
+    for (; i < s.size(); ++i)
+    {
+        if (!isdigit((unsigned char)s[i]) && s[i] != '.') return false;
+    }
+    return true;
+}
+
+// 判断是否为整数常量
+static bool isIntConstant(const string& s)
+{
+    return isConstant(s) && s.find('.') == string::npos;
+}
+
+// 跳转四元式的目标下标，目标为程序末尾时返回 n，不是跳转时返回 -1
+static int jumpTarget(const Quad& q, const map<string, int>& labelPos, int n)
+{
+    if (q.op == "label" || !isControlQuad(q)) return -1;
+    auto it = labelPos.find(q.result);
+    if (it != labelPos.end()) return it->second;
+    if (!q.result.empty() && isdigit((unsigned char)q.result[0])) return min(stoi(q.result) - 1, n);
+    return -1;
+}
+
+ControlFlowGraph buildCFG(const vector<Quad>& code)
+{
+    int n = code.size();
+    map<string, int> labelPos;
+    for (int i = 0; i < n; ++i)
+    {
+        if (code[i].op == "label") labelPos[code[i].result] = i;
+    }
+
+    // 1. 标记首指令
+    vector<bool> leader(n + 1, false);
+    leader[0] = true;
+    for (int i = 0; i < n; ++i)
+    {
+        if (code[i].op == "label") leader[i] = true;
+        int t = jumpTarget(code[i], labelPos, n);
+        if (t < 0) continue;
+        leader[i + 1] = true;
+        leader[t] = true;
+    }
+
+    // 2. 划分基本块
+    ControlFlowGraph cfg;
+    cfg.blockOf.assign(n, -1);
+    for (int i = 0; i < n; ++i)
+    {
+        if (leader[i]) cfg.blocks.push_back({i, i, {}, {}});
+        cfg.blocks.back().end = i + 1;
+        cfg.blockOf[i] = cfg.blocks.size() - 1;
+    }
+
+    // 3. 连边: 块的最后一条四元式决定后继，跳到程序末尾的边不画出
+    int m = cfg.blocks.size();
+    for (int b = 0; b < m; ++b)
+    {
+        const Quad& last = code[cfg.blocks[b].end - 1];
+        int t = jumpTarget(last, labelPos, n);
+        auto link = [&](int target) {
+            if (target >= n) return;
+            int to = cfg.blockOf[target];
+            for (int s : cfg.blocks[b].succ)
+                if (s == to) return;
+            cfg.blocks[b].succ.push_back(to);
+            cfg.blocks[to].pred.push_back(b);
+        };
+        if (!isUnconditionalJump(last)) link(cfg.blocks[b].end);
+        if (t >= 0) link(t);
+    }
+    return cfg;
+}
+
+vector<Loop> findLoops(const ControlFlowGraph& cfg)
+{
+    int m = cfg.blocks.size();
+    vector<Loop> loops;
+    if (m == 0) return loops;
+
+    // 1. 支配集: dom[0] = {0}，dom[b] = {b} ∪ (∩ dom[前驱])
+    vector<vector<bool>> dom(m, vector<bool>(m, true));
+    dom[0].assign(m, false);
+    dom[0][0] = true;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int b = 1; b < m; ++b)
+        {
+            vector<bool> d(m, true);
+            for (int p : cfg.blocks[b].pred)
+                for (int k = 0; k < m; ++k) d[k] = d[k] && dom[p][k];
+            if (cfg.blocks[b].pred.empty()) d.assign(m, false);
+            d[b] = true;
+            if (d != dom[b])
+            {
+                dom[b] = d;
+                changed = true;
+            }
+        }
+    }
+
+    // 2. 回边 b -> h (h 支配 b) 确定的自然循环，同一循环头合并
+    map<int, set<int>> bodies;
+    for (int b = 0; b < m; ++b)
+    {
+        for (int h : cfg.blocks[b].succ)
+        {
+            if (!dom[b][h]) continue;
+            set<int>& body = bodies[h];
+            body.insert(h);
+            vector<int> stack;
+            if (body.insert(b).second) stack.push_back(b);
+            while (!stack.empty())
+            {
+                int x = stack.back();
+                stack.pop_back();
+                for (int p : cfg.blocks[x].pred)
+                    if (body.insert(p).second) stack.push_back(p);
+            }
+        }
+    }
+
+    // 3. 计算四元式区间，检查循环体是否连续
+    for (const auto& entry : bodies)
+    {
+        Loop L;
+        L.header = entry.first;
+        L.blocks.assign(entry.second.begin(), entry.second.end());
+        int lo = cfg.blocks[L.blocks.front()].begin, hi = cfg.blocks[L.blocks.back()].end - 1;
+        int count = 0;
+        for (int b : L.blocks) count += cfg.blocks[b].end - cfg.blocks[b].begin;
+        bool contiguous = count == hi - lo + 1 && lo == cfg.blocks[L.header].begin;
+        L.begin = contiguous ? lo : -1;
+        L.end = hi;
+        loops.push_back(L);
+    }
+    stable_sort(loops.begin(), loops.end(),
+                [](const Loop& x, const Loop& y) { return x.blocks.size() < y.blocks.size(); });
+    return loops;
+}
+
+void printCFG(const vector<Quad>& code, const ControlFlowGraph& cfg)
+{
+    for (size_t b = 0; b < cfg.blocks.size(); ++b)
+    {
+        const BasicBlock& B = cfg.blocks[b];
+        cout << "B" << b << " [" << B.begin + 1 << ", " << B.end << "] -> ";
+        for (int s : B.succ) cout << "B" << s << " ";
+        cout << endl;
+        for (int i = B.begin; i < B.end; ++i)
+            cout << "    " << i + 1 << ": " << code[i].toString() << endl;
+    }
+    for (const auto& L : findLoops(cfg))
+    {
+        cout << "循环: 头 B" << L.header << "，块";
+        for (int b : L.blocks) cout << " B" << b;
+        cout << endl;
+    }
+}
+
+// 循环优化共用的上下文: 新临时变量和标号的编号从生成的名字 (带保留前缀) 的最大编号之后开始，
+// 新名字同样带前缀，与源程序中名为 Tn、Ln 的变量无关
+struct LoopOptContext
+{
+    vector<Quad>& code;
+    int nextTemp;
+    int nextLabel;
+
+    LoopOptContext(vector<Quad>& c) : code(c), nextTemp(0), nextLabel(0)
+    {
+        for (const auto& q : code)
+        {
+            for (const string* s : {&q.arg1, &q.arg2, &q.result})
+                if (isTempName(*s)) nextTemp = max(nextTemp, stoi(s->substr(2)));
+            if (q.op == "label" && q.result.size() > 2 && q.result[0] == kGeneratedMark && q.result[1] == 'L' &&
+                q.result.find_first_not_of("0123456789", 2) == string::npos)
+                nextLabel = max(nextLabel, stoi(q.result.substr(2)));
+        }
+    }
+    string newTemp() { return string(1, kGeneratedMark) + "T" + to_string(++nextTemp); }
+    string newLabel() { return string(1, kGeneratedMark) + "L" + to_string(++nextLabel); }
+
+    // 每个变量在整个程序中的定值次数
+    map<string, int> defCounts() const
+    {
+        map<string, int> defs;
+        for (const auto& q : code)
+            if (!isControlQuad(q)) defs[q.result]++;
+        return defs;
+    }
+
+    // 能否在循环头之前插入只执行一次的代码: 循环头在循环外只有顺序落入的前一个块这一个前驱
+    // (或循环位于程序开头)，插入位置在落入边上，跳向循环头标号的边不会经过它
+    bool hasPreheader(const ControlFlowGraph& cfg, const Loop& L) const
+    {
+        if (L.begin < 0) return false;
+        int outside = 0;
+        for (int p : cfg.blocks[L.header].pred)
+        {
+            if (find(L.blocks.begin(), L.blocks.end(), p) != L.blocks.end()) continue;
+            outside++;
+            if (cfg.blocks[p].end != L.begin || isUnconditionalJump(code[L.begin - 1])) return false;
+        }
+        return outside == 1 || (outside == 0 && L.begin == 0);
+    }
+};
+
+// 可以安全外提的纯运算 (除法可能出错，不外提)
+static bool isPureOp(const string& op)
+{
+    return op == "+" || op == "-" || op == "*" || op == ">" || op == "<" || op == "==" ||
+           op == ">=" || op == "<=" || op == "!=";
+}
+
+// 循环不变代码外提: 外提一个循环中的全部不变运算，返回外提的条数
+static int hoistInvariants(LoopOptContext& ctx, const ControlFlowGraph& cfg, const Loop& L)
+{
+    if (!ctx.hasPreheader(cfg, L)) return 0;
+    vector<Quad>& code = ctx.code;
+    map<string, int> defs = ctx.defCounts();
+
+    set<string> loopDefs;
+    for (int i = L.begin; i <= L.end; ++i)
+        if (!isControlQuad(code[i])) loopDefs.insert(code[i].result);
+
+    // 不变运算外提后其结果也不再在循环内定值，循环直到找不到新的不变运算
+    vector<bool> hoist(code.size(), false);
+    int count = 0;
+    bool found = true;
+    while (found)
+    {
+        found = false;
+        for (int i = L.begin; i <= L.end; ++i)
+        {
+            const Quad& q = code[i];
+            if (hoist[i] || !isPureOp(q.op) || !isTempName(q.result) || defs[q.result] != 1) continue;
+            auto invariant = [&](const string& a) { return isConstant(a) || !loopDefs.count(a); };
+            if (!invariant(q.arg1) || !invariant(q.arg2)) continue;
+            hoist[i] = true;
+            loopDefs.erase(q.result);
+            found = true;
+            count++;
+        }
+    }
+    if (count == 0) return 0;
+
+    vector<Quad> moved, rest;
+    for (int i = L.begin; i <= L.end; ++i)
+        (hoist[i] ? moved : rest).push_back(code[i]);
+    moved.insert(moved.end(), rest.begin(), rest.end());
+    copy(moved.begin(), moved.end(), code.begin() + L.begin);
+    return count;
+}
+
+// 归纳变量强度削弱: 在一个循环中削弱一条乘法，返回是否改写
+static bool reduceStrength(LoopOptContext& ctx, const ControlFlowGraph& cfg, const Loop& L)
+{
+    if (!ctx.hasPreheader(cfg, L)) return false;
+    vector<Quad>& code = ctx.code;
+    map<string, int> defs = ctx.defCounts();
+
+    // 1. 循环内各变量的定值位置
+    map<string, vector<int>> loopDefs;
+    for (int i = L.begin; i <= L.end; ++i)
+        if (!isControlQuad(code[i])) loopDefs[code[i].result].push_back(i);
+
+    // 基本归纳变量 v: 循环内唯一定值为 (=, Tx, -, v)，而 Tx 由 (+, v, c, Tx)、(+, c, v, Tx) 或 (-, v, c, Tx) 得到
+    auto basicStep = [&](const string& v, int& defAt, long long& step) -> bool {
+        auto it = loopDefs.find(v);
+        if (isTempName(v) || it == loopDefs.end() || it->second.size() != 1) return false;
+        defAt = it->second[0];
+        const Quad& d = code[defAt];
+        if (d.op != "=" || !isTempName(d.arg1)) return false;
+        auto src = loopDefs.find(d.arg1);
+        if (src == loopDefs.end() || src->second.size() != 1) return false;
+        const Quad& inc = code[src->second[0]];
+        if (inc.op == "+" && inc.arg1 == v && isIntConstant(inc.arg2)) step = stoll(inc.arg2);
+        else if (inc.op == "+" && inc.arg2 == v && isIntConstant(inc.arg1)) step = stoll(inc.arg1);
+        else if (inc.op == "-" && inc.arg1 == v && isIntConstant(inc.arg2)) step = -stoll(inc.arg2);
+        else return false;
+        return true;
+    };
+
+    // 2. 找一条 (*, v, k, T) 或 (*, k, v, T)，k 为整数常量
+    for (int m = L.begin; m <= L.end; ++m)
+    {
+        const Quad q = code[m];
+        if (q.op != "*" || !isTempName(q.result) || defs[q.result] != 1) continue;
+        string v, k;
+        if (isIntConstant(q.arg2)) v = q.arg1, k = q.arg2;
+        else if (isIntConstant(q.arg1)) v = q.arg2, k = q.arg1;
+        else continue;
+        int defAt;
+        long long step;
+        if (!basicStep(v, defAt, step)) continue;
+
+        // 3. 改写: 循环前 S = v * k；乘法改为 T = S；v 更新后 S = S + c * k
+        string S = ctx.newTemp();
+        code[m] = {"=", S, "-", q.result};
+        code.insert(code.begin() + defAt + 1, {"+", S, to_string(step * stoll(k)), S});
+        code.insert(code.begin() + L.begin, {"*", v, k, S});
+        m += (m > defAt ? 1 : 0) + 1; // 两次插入后 T = S 所在的新下标
+
+        // 4. 复制传播: T 只在同一基本块中其后被使用一次，且其间 S 没有被重新定值时，直接使用 S
+        int uses = 0, useAt = -1;
+        for (int i = 0; i < (int)code.size(); ++i)
+        {
+            if (code[i].arg1 == q.result || code[i].arg2 == q.result || (isControlQuad(code[i]) && code[i].result == q.result))
+            {
+                uses++;
+                useAt = i;
+            }
+        }
+        bool sameBlock = uses == 1 && useAt > m;
+        for (int i = m + 1; sameBlock && i <= useAt; ++i)
+        {
+            if (i < useAt && (code[i].op == "label" || isControlQuad(code[i]) || code[i].result == S)) sameBlock = false;
+            if (i == useAt && code[i].op == "label") sameBlock = false;
+        }
+        if (sameBlock)
+        {
+            if (code[useAt].arg1 == q.result) code[useAt].arg1 = S;
+            if (code[useAt].arg2 == q.result) code[useAt].arg2 = S;
+            code.erase(code.begin() + m);
+        }
+        return true;
+    }
+    return false;
+}
+
+// 循环倒置: 把入口处的条件测试复制到循环底部，返回是否改写
+static bool invertLoop(LoopOptContext& ctx, const Loop& L)
+{
+    vector<Quad>& code = ctx.code;
+    int n = code.size();
+    int b = L.begin, e = L.end;
+    if (b < 0 || code[b].op != "label" || !isUnconditionalJump(code[e]) || code[e].result != code[b].result) return false;
+    string Ls = code[b].result;
+
+    int refs = 0;
+    for (const auto& q : code)
+        if (q.op != "label" && isControlQuad(q) && q.result == Ls) refs++;
+    if (refs != 1) return false;
+
+    // 条件代码之后的第一条控制四元式必须是出口测试，出口标号紧跟在循环之后
+    int t = b + 1;
+    while (t < e && !isControlQuad(code[t])) t++;
+    if (t >= e || code[t].op != "jfalse" || e + 1 >= n || code[e + 1].op != "label" || code[e + 1].result != code[t].result)
+        return false;
+
+    string Lb = ctx.newLabel();
+    vector<Quad> cond(code.begin() + b + 1, code.begin() + t);
+    vector<Quad> out = cond;
+    out.push_back(code[t]);
+    out.push_back({"label", "-", "-", Lb});
+    out.insert(out.end(), code.begin() + t + 1, code.begin() + e);
+    out.insert(out.end(), cond.begin(), cond.end());
+    out.push_back({"jtrue", code[t].arg1, "-", Lb});
+
+    code.erase(code.begin() + b, code.begin() + e + 1);
+    code.insert(code.begin() + b, out.begin(), out.end());
+    return true;
+}
+
+LoopOptStats optimizeLoops(vector<Quad>& code)
+{
+    LoopOptStats stats = {0, 0, 0, 0};
+    for (const auto& q : code)
+    {
+        if (q.op != "label" && isControlQuad(q) && !q.result.empty() && isdigit((unsigned char)q.result[0]))
+            return stats; // 回填模式
+    }
+    stats.loops = findLoops(buildCFG(code)).size();
+    LoopOptContext ctx(code);
+
+    // 每次改写后重新建立控制流图，内层循环优先
+    auto runPass = [&](auto transform) {
+        int total = 0;
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            ControlFlowGraph cfg = buildCFG(code);
+            for (const auto& L : findLoops(cfg))
+            {
+                int k = transform(cfg, L);
+                if (k == 0) continue;
+                total += k;
+                changed = true;
+                break;
+            }
+        }
+        return total;
+    };
+    stats.hoisted = runPass([&](const ControlFlowGraph& cfg, const Loop& L) { return hoistInvariants(ctx, cfg, L); });
+    stats.reduced = runPass([&](const ControlFlowGraph& cfg, const Loop& L) { return (int)reduceStrength(ctx, cfg, L); });
+    stats.inverted = runPass([&](const ControlFlowGraph&, const Loop& L) { return (int)invertLoop(ctx, L); });
+    return stats;
+}
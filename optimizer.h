@@ -0,0 +1,114 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "common.h"
+
+/**
+ * @brief 临时变量复用的统计结果
+ */
+struct TempRecycleStats
+{
+    int originalTemps; // 复用前出现的不同临时变量个数
+    int slots;         // 复用后实际需要的临时变量个数 (T1..Tslots)
+    int peakLive;      // 任意一点同时活跃的临时变量的最大个数
+};
+
+/**
+ * @brief 判断一个名字是否为 Parser::newTemp() 生成的临时变量 (带保留前缀 kGeneratedMark 的 T1, T2...)
+ * 源程序中名为 T1 的变量没有前缀，不算临时变量
+ */
+bool isTempName(const string& s);
+
+/**
+ * @brief 基于活跃性分析的临时变量复用
+ *
+ * 过程:
+ * 1. 根据 label/jfalse/jump (或回填模式的序号跳转) 建立四元式之间的控制流后继关系
+ * 2. 反向迭代求出每条四元式出口处活跃的临时变量集合
+ * 3. 定值点与出口活跃变量互相冲突，按首次定值的顺序贪心分配编号最小的空闲槽位
+ * 4. 用槽位重新命名临时变量 (T1..Tk，仍带保留前缀；跳过源程序中已有的变量名 Tn)
+ *
+ * 只改写分析器生成的临时变量，四元式须在 Parser::placeholderNames 打开时生成，之后由 rebaseQuads() 去掉前缀
+ * @param code 待改写的四元式序列 (原地修改)
+ * @return 复用前后的临时变量个数以及峰值活跃数
+ */
+TempRecycleStats renumberTemps(vector<Quad>& code);
+
+/**
+ * @brief 基本块: 四元式下标区间 [begin, end)
+ */
+struct BasicBlock 
+{
+    int begin, end;
+    vector<int> succ; // 后继基本块
+    vector<int> pred; // 前驱基本块
+};
+
+/**
+ * @brief 控制流图
+ */
+struct ControlFlowGraph 
+{
+    vector<BasicBlock> blocks; // 按四元式顺序排列，块 0 为入口
+    vector<int> blockOf;       // [四元式下标] -> 所在基本块
+};
+
+/**
+ * @brief 自然循环
+ */
+struct Loop 
+{
+    int header;          // 循环头基本块 (支配循环中所有块)
+    vector<int> blocks;  // 循环包含的基本块 (含嵌套的内层循环)
+    int begin, end;      // 循环覆盖的四元式下标区间 [begin, end]，循环体不连续时 begin 为 -1
+};
+
+/**
+ * @brief 根据四元式建立基本块与控制流图
+ * 首指令: 第一条四元式、label、任何跳转之后的一条以及序号形式的跳转目标；
+ * 跳转目标为标号名 (普通模式) 或从 1 开始的四元式序号 (回填模式)
+ */
+ControlFlowGraph buildCFG(const vector<Quad>& code);
+
+/**
+ * @brief 找出控制流图中的自然循环
+ * 迭代求支配集，目标支配源的边为回边，从回边的源逆向收集到循环头为止的块即为循环体；
+ * 同一循环头的多条回边合并为一个循环
+ * @return 按包含的块数从少到多排列 (内层循环在前)
+ */
+vector<Loop> findLoops(const ControlFlowGraph& cfg);
+
+/**
+ * @brief 打印基本块、控制流边与循环
+ */
+void printCFG(const vector<Quad>& code, const ControlFlowGraph& cfg);
+
+/**
+ * @brief 循环优化的统计结果
+ */
+struct LoopOptStats 
+{
+    int loops;    // 找到的循环个数
+    int hoisted;  // 外提的循环不变计算条数
+    int reduced;  // 强度削弱的乘法条数
+    int inverted; // 倒置的循环个数
+};
+
+/**
+ * @brief 对 while 循环生成的四元式做循环优化 (普通模式，跳转目标为标号)
+ *
+ * 依次进行 (每一步都在重新建立的控制流图上，内层循环优先):
+ * 1. 循环不变代码外提: 运算对象在循环内没有定值、结果为只定值一次的临时变量的运算，移到循环头之前
+ * 2. 归纳变量强度削弱: 对循环中唯一定值为 v = v ± c 的变量 v，把 T = v * k 改为读取新临时变量 S，
+ *    S 在循环前初始化为 v * k，并在 v 每次增加后加上 c * k
+ * 3. 循环倒置: label Ls; C; jfalse T Le; 循环体; jump Ls  改写为
+ *    C; jfalse T Le; label Lb; 循环体; C; jtrue T Lb，每次迭代少执行一次跳转
+ *
+ * 回填模式的代码以序号作为跳转目标，移动四元式会改变序号，因此原样返回。
+ * 只把带保留前缀的名字当作临时变量 (见 isTempName())，新临时变量和标号接着生成的名字编号，同样带前缀，
+ * 源程序中名为 T3 的变量按普通变量处理
+ * @param code 待优化的四元式序列 (原地修改)
+ */
+LoopOptStats optimizeLoops(vector<Quad>& code);
+
+#endif
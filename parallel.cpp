@@ -0,0 +1,167 @@
+#include "parallel.h"
+#include "parser.h"
+#include "optimizer.h"
+#include <thread>
+#include <atomic>
+#include <cctype>
+
+// 判断跳转目标是否为回填模式的四元式序号
+static bool isIndexTarget(const Quad& q) 
+{
+    if (q.op.empty() || q.op[0] != 'j' || q.result.empty()) return false;
+    for (char c : q.result) 
+    {
+        if (!isdigit((unsigned char)c)) return false;
+    }
+    return true;
+}
+
+void rebaseQuads(vector<Quad>& code, int tempBase, int labelBase, int indexBase, bool keepMark) 
+{
+    // 生成的名字: kGeneratedMark + 'T'/'L' + 编号
+    string prefix = keepMark ? string(1, kGeneratedMark) : string();
+    auto rename = [&](string& s) {
+        if (s.size() < 3 || s[0] != kGeneratedMark) return;
+        int base = s[1] == 'T' ? tempBase : labelBase;
+        s = prefix + s[1] + to_string(stoi(s.substr(2)) + base);
+    };
+    for (auto& q : code) 
+    {
+        rename(q.arg1);
+        rename(q.arg2);
+        if (isIndexTarget(q)) 
+        {
+            if (indexBase) q.result = to_string(stoi(q.result) + indexBase);
+        }
+        else rename(q.result);
+    }
+}
+
+vector<pair<size_t, size_t>> splitAtStatements(const string& src, size_t minChunk) 
+{
+    vector<pair<size_t, size_t>> chunks;
+    size_t start = 0;
+    int depth = 0;
+    for (size_t i = 0; i < src.size(); ++i) 
+    {
+        if (src[i] == '{') depth++;
+        else if (src[i] == '}' && --depth == 0 && i + 1 - start >= minChunk) 
+        {
+            chunks.push_back({start, i + 1 - start});
+            start = i + 1;
+        }
+    }
+    // 剩余部分若只有空白则并入上一块
+    bool blank = true;
+    for (size_t i = start; i < src.size() && blank; ++i) 
+        blank = isspace((unsigned char)src[i]) != 0;
+    if (!blank || chunks.empty()) chunks.push_back({start, src.size() - start});
+    else chunks.back().second = src.size() - chunks.back().first;
+    return chunks;
+}
+
+ParallelParser::ParallelParser(GrammarAnalyzer& grammar, int threadCount) 
+    : G(grammar), threads(threadCount), minChunk(64 * 1024), recycleTemps(false), backpatch(false), chunks(0), errorOffset(0) 
+{
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+}
+
+bool ParallelParser::parse(const string& src) 
+{
+    result.clear();
+    errorSymbol.clear();
+    errorOffset = 0;
+
+    // 1. 切分: 块数取线程数的若干倍，使各线程的负载大致均衡
+    size_t target = max(minChunk, src.size() / (threads * 4) + 1);
+    vector<pair<size_t, size_t>> parts = splitAtStatements(src, target);
+    chunks = parts.size();
+
+    if (chunks == 1 || threads == 1) 
+    {
+        Parser parser(G);
+        parser.verbose = false;
+        parser.recycleTemps = recycleTemps;
+        parser.backpatch = backpatch;
+        if (!parser.parse(src)) 
+        {
+            errorSymbol = parser.errorSymbol;
+            errorOffset = parser.errorOffset;
+            return false;
+        }
+        result = move(parser.result);
+        return true;
+    }
+
+    vector<vector<Quad>> pieces(chunks);
+    vector<QuadNumbering> numbering(chunks);
+    vector<char> ok(chunks, 0);
+    vector<pair<string, size_t>> errors(chunks); // 出错块的 (出错符号, 在源代码中的位置)
+    int workers = min(threads, chunks);
+
+    // 在 workers 个线程上对 [0, chunks) 中的每一块执行 job，块按原子计数器动态分配
+    auto runParallel = [&](auto job) {
+        atomic<int> next(0);
+        vector<thread> pool;
+        for (int w = 0; w < workers; ++w) 
+        {
+            pool.emplace_back([&]() {
+                int i;
+                while ((i = next++) < chunks) job(i);
+            });
+        }
+        for (auto& t : pool) t.join();
+    };
+
+    // 2. 各块独立分析，每个线程使用自己的 Parser
+    runParallel([&](int i) {
+        Parser parser(G);
+        parser.verbose = false;
+        parser.backpatch = backpatch;
+        parser.placeholderNames = true;
+        if (!parser.parse(string_view(src).substr(parts[i].first, parts[i].second))) 
+        {
+            errors[i] = {parser.errorSymbol, parts[i].first + parser.errorOffset};
+            return;
+        }
+        pieces[i] = move(parser.result);
+        numbering[i] = parser.numbering();
+        ok[i] = 1;
+    });
+    for (int i = 0; i < chunks; ++i) 
+    {
+        // 报告最靠前的出错块
+        if (!ok[i]) 
+        {
+            errorSymbol = errors[i].first;
+            errorOffset = errors[i].second;
+            return false;
+        }
+    }
+
+    // 3. 前缀和得到每块的编号偏移，再并行重新编号
+    vector<QuadNumbering> base(chunks);
+    vector<size_t> offset(chunks + 1, 0);
+    QuadNumbering sum = {0, 0};
+    for (int i = 0; i < chunks; ++i) 
+    {
+        base[i] = sum;
+        sum.temps += numbering[i].temps;
+        sum.labels += numbering[i].labels;
+        offset[i + 1] = offset[i] + pieces[i].size();
+    }
+    runParallel([&](int i) {
+        rebaseQuads(pieces[i], base[i].temps, base[i].labels, offset[i], recycleTemps);
+    });
+
+    // 4. 拼接
+    result.reserve(offset[chunks]);
+    for (auto& piece : pieces) 
+        result.insert(result.end(), make_move_iterator(piece.begin()), make_move_iterator(piece.end()));
+    if (recycleTemps) 
+    {
+        renumberTemps(result);
+        rebaseQuads(result, 0, 0, 0);
+    }
+    return true;
+}
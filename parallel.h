@@ -0,0 +1,70 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "common.h"
+#include "grammar.h"
+#include "parser.h"
+
+/**
+ * @brief 把独立分析得到的一段四元式重新编号，使其可以拼接在其他代码之后
+ * 只改写分析器生成的名字 (以 kGeneratedMark 开头，见 Parser::placeholderNames):
+ * 临时变量 Tn -> T(n+tempBase)，标号 Ln -> L(n+labelBase)，源程序中的变量原样保留；
+ * 回填模式中以序号书写的跳转目标加上 indexBase。各基数均为 0 时只去掉保留前缀
+ * @param code 待改写的四元式序列 (原地修改)
+ * @param keepMark 保留前缀 (之后还要由 renumberTemps() 识别生成的临时变量)
+ */
+void rebaseQuads(vector<Quad>& code, int tempBase, int labelBase, int indexBase, bool keepMark = false);
+
+/**
+ * @brief 在顶层语句边界切分源代码
+ * 扫描花括号的嵌套深度，深度回到 0 的 '}' 之后是一条顶层语句的结束，
+ * 从该处切分的每一块都是一个完整的语句序列，可以独立分析
+ * @param src 源代码
+ * @param minChunk 每块的最小字节数
+ * @return 各块的 (起始位置, 长度)
+ */
+vector<pair<size_t, size_t>> splitAtStatements(const string& src, size_t minChunk);
+
+/**
+ * @brief 并行语法分析器
+ *
+ * 面向由大量顶层语句组成的大型源文件 (文法需包含语句序列，如 testfile_seq.txt):
+ * 1. 在顶层 '}' 处把输入切分为若干块
+ * 2. 多个线程各自持有一个 Parser，从共享的块队列中取块分析 (分析表只读，可共享)
+ * 3. 按块的顺序累加各块分析器报告的临时变量、标号个数和四元式的个数，各线程并行地对本块重新编号
+ * 4. 依次拼接，结果与串行分析完全一致
+ *
+ * 串行分析中前一块的全部临时变量和标号都先于后一块生成，回填模式下前一块的出口链
+ * 恰好回填到后一块的第一条四元式，因此按块偏移重新编号即可得到相同的结果。
+ * 临时变量复用需要全局的活跃性信息，在拼接之后统一进行。
+ */
+class ParallelParser 
+{
+    GrammarAnalyzer& G;
+
+public:
+    int threads;          ///< 工作线程数
+    size_t minChunk;      ///< 每块的最小字节数，过小的块分析开销不足以抵消调度开销
+    bool recycleTemps;    ///< 是否在拼接后做活跃性分析并复用临时变量
+    bool backpatch;       ///< 是否使用回填方式生成条件与循环代码
+    vector<Quad> result;  ///< 最近一次分析成功生成的四元式序列
+    int chunks;           ///< 最近一次分析切分的块数
+    string errorSymbol;   ///< 最近一次分析失败时出错处的符号 (取最靠前的出错块)
+    size_t errorOffset;   ///< 出错符号之后在整个源代码中的字节位置
+
+    /**
+     * @param grammar 已构建好分析表的文法分析器
+     * @param threadCount 工作线程数，0 表示使用硬件线程数
+     */
+    ParallelParser(GrammarAnalyzer& grammar, int threadCount = 0);
+
+    /**
+     * @brief 并行分析一段源代码
+     * 只能切出一块时直接串行分析。各块的分析器是静默的，出错时不打印，
+     * 而是记录最靠前的出错块中的出错符号和位置 (errorSymbol, errorOffset)，由调用者报告
+     * @return 分析成功返回 true，四元式保存在 result 中
+     */
+    bool parse(const string& src);
+};
+
+#endif
@@ -1,225 +1,576 @@
 #include "parser.h"
 #include "lexer.h"
+#include "optimizer.h"
+#include "parallel.h"
 #include <stack>
 #include <fstream>
 
-Parser::Parser(GrammarAnalyzer& grammar) : G(grammar), tempCount(0), labelCount(0) {}
+Parser::Parser(GrammarAnalyzer& grammar) : G(grammar), tempCount(0), labelCount(0), recycleTemps(false), backpatch(false), loopOpt(false), verbose(true), profiling(false), placeholderNames(false), streamed(0), errorOffset(0) {}
+
+// 循环优化和临时变量复用靠保留前缀识别生成的名字，接受时再去掉 (流式模式下不做这两项)
+bool Parser::markNames() const 
+{
+    return placeholderNames || (!sink && (recycleTemps || loopOpt));
+}
 
 string Parser::newTemp() 
 { 
-    return "T" + to_string(++tempCount); 
+    return (markNames() ? string(1, kGeneratedMark) : string()) + "T" + to_string(++tempCount); 
 }
 string Parser::newLabel() 
 { 
-    return "L" + to_string(++labelCount); 
+    return (markNames() ? string(1, kGeneratedMark) : string()) + "L" + to_string(++labelCount); 
+}
+
+QuadNumbering Parser::numbering() const 
+{
+    return {tempCount, labelCount};
+}
+
+int Parser::topState() const 
+{
+    return stateStack.top();
+}
+
+void Parser::restartNumbering() 
+{
+    tempCount = 0;
+    labelCount = 0;
+    streamed = 0;
+}
+
+// 判断是否为算术运算符
+static bool isArithOp(const string& op) 
+{
+    return op == "+" || op == "-" || op == "*" || op == "/";
 }
 
 /**
- * @brief 核心分析函数
+ * @brief 普通模式下的语义动作
+ * 根据不同的产生式，生成对应的四元式代码，代码随属性 code 自底向上拼接
+ */
+void Parser::semanticAction(const Production& prod, vector<Attribute>& rhsAttrs, Attribute& lhsAttr) 
+{
+    // 产生式: S -> while ( C ) { S }
+    // 逻辑:
+    // 1. 生成两个标号 startLabel, exitLabel
+    // 2. 代码结构:
+    //    startLabel:
+    //    (C 的代码)
+    //    if C is false goto exitLabel
+    //    (S 的代码)
+    //    goto startLabel
+    //    exitLabel:
+
+    // 填该Push进符号栈的符号lhsAttr也就是规约产生式左部符号
+    if (prod.rhs.size() == 7 && prod.rhs[0] == "while") 
+    {
+        Attribute& C = rhsAttrs[2];
+        Attribute& S1 = rhsAttrs[5];
+        
+        string startLabel = newLabel();
+        string exitLabel = newLabel();
+        
+        lhsAttr.code.push_back({"label", "-", "-", startLabel});//放置循环开始的标签L1，方便跳转
+        lhsAttr.code.insert(lhsAttr.code.end(), C.code.begin(), C.code.end());//插入条件C的代码
+        lhsAttr.code.push_back({"jfalse", C.place, "-", exitLabel});//如果C为假，跳转到出口L2
+        lhsAttr.code.insert(lhsAttr.code.end(), S1.code.begin(), S1.code.end());//C为真，执行S1代码
+        lhsAttr.code.push_back({"jump", "-", "-", startLabel});//生成无条件跳转指令，回到开头L1中
+        lhsAttr.code.push_back({"label", "-", "-", exitLabel});//循环退出的标签L2
+    }
+    // 产生式: S -> id = E
+    // 逻辑: 生成赋值四元式 (=, E.place, -, id.place)
+    else if (prod.rhs.size() == 3 && prod.rhs[1] == "=") 
+    {
+        Attribute id = rhsAttrs[0];
+        Attribute E = rhsAttrs[2];
+        
+        lhsAttr.code = E.code; // 继承 E 的代码（如果E = a+b这种复杂形式表达式时）
+        lhsAttr.code.push_back({"=", E.place, "-", id.place});
+    }
+    // 产生式: C -> E > E
+    // 逻辑: 生成比较四元式 (>, E1.place, E2.place, newTemp)
+    else if (prod.rhs.size() == 3 && prod.rhs[1] == ">") 
+    {
+        Attribute E1 = rhsAttrs[0];
+        Attribute E2 = rhsAttrs[2];
+        
+        lhsAttr.place = newTemp();//将计算结果临时存放在临时变量Tn中
+        //当E1和E2均是复杂表达式时
+        lhsAttr.code = E1.code;
+        lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
+        //添加四元式，结果存放在临时变量newTemp()中
+        lhsAttr.code.push_back({">", E1.place, E2.place, lhsAttr.place});
+    }
+    // 产生式: C -> E < E
+    else if (prod.rhs.size() == 3 && prod.rhs[1] == "<") 
+    {
+        Attribute E1 = rhsAttrs[0];
+        Attribute E2 = rhsAttrs[2];
+        
+        lhsAttr.place = newTemp();
+        lhsAttr.code = E1.code;
+        lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
+        lhsAttr.code.push_back({"<", E1.place, E2.place, lhsAttr.place});
+    }
+    // 产生式: C -> E == E
+    else if (prod.rhs.size() == 3 && prod.rhs[1] == "==") 
+    {
+        Attribute E1 = rhsAttrs[0];
+        Attribute E2 = rhsAttrs[2];
+        
+        lhsAttr.place = newTemp();
+        lhsAttr.code = E1.code;
+        lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
+        lhsAttr.code.push_back({"==", E1.place, E2.place, lhsAttr.place});
+    }
+    // 产生式: E -> id + E 或 E -> num + E，以及带优先级声明的 E -> E + E | E * E 等
+    // 逻辑: 先执行两个运算对象的代码，再生成 (op, E1.place, E2.place, newTemp)
+    else if (prod.rhs.size() == 3 && isArithOp(prod.rhs[1])) 
+    {
+        Attribute op1 = rhsAttrs[0]; // id、num 或 E
+        Attribute E2 = rhsAttrs[2];
+        
+        lhsAttr.place = newTemp();
+        lhsAttr.code = op1.code;
+        lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
+        lhsAttr.code.push_back({prod.rhs[1], op1.place, E2.place, lhsAttr.place});
+    }
+    // 产生式: E -> ( E )
+    // 逻辑: 括号不产生代码，直接传递 E 的属性
+    else if (prod.rhs.size() == 3 && prod.rhs[0] == "(" && prod.rhs[2] == ")") 
+    {
+        lhsAttr = rhsAttrs[1];
+    }
+    // 产生式: E -> id
+    // 逻辑: 传递属性
+    // 无需产生四元式
+    else if (prod.rhs.size() == 1 && prod.rhs[0] == "id") 
+    {
+        lhsAttr.place = rhsAttrs[0].place;//E的变量 = id的变量
+    }
+    // 产生式: E -> num
+    else if (prod.rhs.size() == 1 && prod.rhs[0] == "num") 
+    {
+        lhsAttr.place = rhsAttrs[0].place;
+    }
+    // 其他单符号产生式 (如 E -> T): 原样传递属性
+    // 这类归约没有语义效果，因此可以被 eliminateUnitReductions() 从分析表中跳过
+    else if (prod.rhs.size() == 1) 
+    {
+        lhsAttr = rhsAttrs[0];
+    }
+    // 产生式: P -> P S (语句序列)
+    // 逻辑: 依次拼接两部分的代码，左递归时前一部分的代码直接移动，避免反复复制
+    else if (prod.rhs.size() == 2) 
+    {
+        lhsAttr = move(rhsAttrs[0]);
+        lhsAttr.code.insert(lhsAttr.code.end(), rhsAttrs[1].code.begin(), rhsAttrs[1].code.end());
+    }
+}
+
+int Parser::emit(const Quad& q) 
+{
+    emitted.push_back(q);
+    return streamed + emitted.size() - 1;
+}
+
+void Parser::backpatchList(const vector<int>& list, int target) 
+{
+    for (int i : list) 
+        emitted[i - streamed].result = to_string(target + 1);
+}
+
+/**
+ * @brief 回填模式下的语义动作
+ * 四元式直接追加到全局序列 emitted 中，条件表达式不再计算布尔临时变量，
+ * 而是生成 (j>, a, b, 目标) 形式的条件跳转，并把尚未确定目标的跳转记入真/假出口链，
+ * 待目标四元式的下标确定后再回填。
+ */
+void Parser::backpatchAction(const Production& prod, vector<Attribute>& rhsAttrs, Attribute& lhsAttr) 
+{
+    int start = streamed + emitted.size();
+
+    // 产生式: S -> while ( C ) { S }
+    // 代码结构:
+    //    C.begin: (j关系, a, b, S1.begin)   <- C 的真出口
+    //             (j, -, -, 待回填)         <- C 的假出口，成为 S 的 nextList
+    //    S1.begin: (S1 的代码)              <- S1 的 nextList 回填到 C.begin
+    //             (j, -, -, C.begin)
+    if (prod.rhs.size() == 7 && prod.rhs[0] == "while") 
+    {
+        Attribute& C = rhsAttrs[2];
+        Attribute& S1 = rhsAttrs[5];
+
+        backpatchList(C.trueList, S1.begin);
+        backpatchList(S1.nextList, C.begin);
+        emit({"j", "-", "-", to_string(C.begin + 1)});
+        lhsAttr.nextList = C.falseList;
+        lhsAttr.begin = C.begin;
+    }
+    // 产生式: S -> id = E
+    else if (prod.rhs.size() == 3 && prod.rhs[1] == "=") 
+    {
+        emit({"=", rhsAttrs[2].place, "-", rhsAttrs[0].place});
+        lhsAttr.begin = rhsAttrs[2].begin >= 0 ? rhsAttrs[2].begin : start;
+    }
+    // 产生式: C -> E > E | E < E | E == E
+    // 逻辑: 真出口 (j关系, E1.place, E2.place, -)，假出口 (j, -, -, -)
+    else if (prod.rhs.size() == 3 && (prod.rhs[1] == ">" || prod.rhs[1] == "<" || prod.rhs[1] == "==")) 
+    {
+        Attribute& E1 = rhsAttrs[0];
+        Attribute& E2 = rhsAttrs[2];
+
+        lhsAttr.trueList.push_back(emit({"j" + prod.rhs[1], E1.place, E2.place, "-"}));
+        lhsAttr.falseList.push_back(emit({"j", "-", "-", "-"}));
+        if (E1.begin >= 0) lhsAttr.begin = E1.begin;
+        else if (E2.begin >= 0) lhsAttr.begin = E2.begin;
+        else lhsAttr.begin = start;
+    }
+    // 产生式: E -> id + E、E -> E * E 等算术运算
+    else if (prod.rhs.size() == 3 && isArithOp(prod.rhs[1])) 
+    {
+        Attribute& E1 = rhsAttrs[0];
+        Attribute& E2 = rhsAttrs[2];
+
+        lhsAttr.place = newTemp();
+        emit({prod.rhs[1], E1.place, E2.place, lhsAttr.place});
+        if (E1.begin >= 0) lhsAttr.begin = E1.begin;
+        else if (E2.begin >= 0) lhsAttr.begin = E2.begin;
+        else lhsAttr.begin = start;
+    }
+    // 产生式: E -> ( E )
+    else if (prod.rhs.size() == 3 && prod.rhs[0] == "(" && prod.rhs[2] == ")") 
+    {
+        lhsAttr = rhsAttrs[1];
+    }
+    // 产生式: E -> id、E -> num 等单符号产生式，传递属性，无需产生四元式
+    else if (prod.rhs.size() == 1) 
+    {
+        lhsAttr = rhsAttrs[0];
+    }
+    // 产生式: P -> P S (语句序列)
+    // 逻辑: P 的 nextList 回填到 S 的第一条四元式，序列的出口即 S 的出口
+    else if (prod.rhs.size() == 2) 
+    {
+        Attribute& P = rhsAttrs[0];
+        Attribute& S = rhsAttrs[1];
+
+        backpatchList(P.nextList, S.begin);
+        lhsAttr.nextList = S.nextList;
+        lhsAttr.begin = P.begin;
+    }
+}
+
+void Parser::reset() 
+{
+    while (!stateStack.empty()) stateStack.pop();
+    while (!symbolStack.empty()) symbolStack.pop();
+    stateStack.push(0); // 初始状态
+    emitted.clear();
+    result.clear();
+    errorSymbol.clear();
+    errorOffset = 0;
+    streamed = 0;
+    stats = {0, 0, 0, 0};
+    tempCount = 0;  // 每次分析都是独立的编译单元，临时变量和标号从 1 开始编号
+    labelCount = 0;
+    step = 0;
+}
+
+// 记录当前状态的访问次数
+void Parser::countState(int s) 
+{
+    if (!profiling) return;
+    if (s >= (int)profile.stateHits.size()) profile.stateHits.resize(s + 1, 0);
+    profile.stateHits[s]++;
+}
+
+/**
+ * @brief 归约动作
+ * 弹出 |RHS| 个状态和符号，查 Goto 表压入新状态，执行语义动作
+ * @return Goto 表中没有该转移时返回 false (惰性模式下存在冲突的行被置空)，此时分析应停止
+ */
+bool Parser::reduce(int prodId) 
+{
+    Production prod = G.grammar[prodId];//获取规约的那条产生式prod
+    if (verbose) cout << "归约 " << prod.toString() << endl;
+    stats.reductions++;
+    int len = prod.rhs.size();//获取规约的数量
+    
+    // 弹出右部符号对应的属性，准备进行语义计算
+    // 弹出对应产生式右部数量的状态栈和符号栈，符号栈的弹出用Attribute数组rhsAttrs记录下来
+    vector<Attribute> rhsAttrs(len);
+    for (int i = len - 1; i >= 0; --i) 
+    {
+        stateStack.pop();
+        rhsAttrs[i] = move(symbolStack.top());
+        symbolStack.pop();
+    }
+    
+    // 规约完后根据状态栈顶ID和产生式左部非终结符符号跳转（GOTO）到对应状态中
+    // 状态转移: Goto[当前栈顶][LHS]
+    int t = stateStack.top();
+    stats.tableLookups++;
+    if (profiling) profile.transitionHits[{t, prod.lhs}]++;
+    int next = G.lookupGoto(t, prod.lhs);
+    if (next < 0) 
+        return false;
+    stateStack.push(next);//将跳转后的ID压入状态栈中
+    
+    Attribute lhsAttr; // 产生式左部的属性
+    
+    // --- 语义动作 (Semantic Actions) ---
+    if (backpatch) 
+        backpatchAction(prod, rhsAttrs, lhsAttr);
+    else 
+        semanticAction(prod, rhsAttrs, lhsAttr);
+    
+    symbolStack.push(move(lhsAttr));//将规约完的表达式存入符号栈中
+    if (sink && symbolStack.size() == 1) 
+    {
+        streamPrefix();
+        if (onTopLevel) onTopLevel();
+    }
+    return true;
+}
+
+/**
+ * @brief 流式输出已经确定的四元式
+ *
+ * 属性栈只剩一个符号 X 时，X 的代码是整个程序代码的前缀:
+ * 各语义动作生成的代码都以第一个右部符号的代码开头 (终结符没有代码)，之后以 X 为第一个右部符号的归约
+ * 只会在其后追加。因此对语句序列文法，每归约完一条顶层语句，它的四元式就可以送出并从属性栈中丢弃，
+ * 属性栈中暂存的代码只与嵌套深度有关，与程序长度无关。
+ *
+ * 回填模式下四元式的下标是全局的，还要等跳转目标确定:
+ * - X 的 nextList 之后只会回填到下一个语法成分的第一条四元式 (P -> P S) 或代码末尾 (接受)，
+ *   两者都是当前序列的末尾，可以现在就回填
+ * - trueList/falseList 的目标尚未确定，只送出其中最小下标之前的四元式
+ */
+void Parser::streamPrefix() 
+{
+    Attribute& x = symbolStack.top();
+    if (!backpatch) 
+    {
+        for (const auto& q : x.code) sink(q);
+        streamed += x.code.size();
+        vector<Quad>().swap(x.code);
+        return;
+    }
+
+    int end = streamed + emitted.size();
+    backpatchList(x.nextList, end);
+    x.nextList.clear();
+    int limit = end;
+    for (int i : x.trueList) limit = min(limit, i);
+    for (int i : x.falseList) limit = min(limit, i);
+    int count = limit - streamed;
+    for (int i = 0; i < count; ++i) sink(emitted[i]);
+    emitted.erase(emitted.begin(), emitted.begin() + count);
+    streamed = limit;
+}
+
+/**
+ * @brief 连续执行默认归约
+ * 默认归约状态不需要向前看符号，也不查 Action 表
+ * @param val 打印分析过程时显示的向前看符号 (尚未读入时为 "-")
+ * @return 某次归约查不到 Goto 转移时返回 false
+ */
+bool Parser::drainDefaultReductions(const string& val) 
+{
+    while (true) 
+    {
+        int s = stateStack.top();
+        if (s >= (int)G.defaultReduce.size() || G.defaultReduce[s] < 0) return true;
+        countState(s);
+        stats.defaultReductions++;
+        if (verbose) cout << ++step << "\t" << s << "\t\t" << val << "\t";
+        if (!reduce(G.defaultReduce[s])) return false;
+    }
+}
+
+/**
+ * @brief 语法错误: 记录出错处的符号，非静默模式下打印
+ */
+ParseStatus Parser::syntaxError(const string& val) 
+{
+    errorSymbol = val;
+    if (verbose) 
+    {
+        cout << "错误" << endl;
+        cout << "语法错误，在符号 " << val << " 处" << endl;
+    }
+    return PARSE_ERROR;
+}
+
+/**
+ * @brief 接受动作: 取出最终的四元式，按选项做后处理并输出
+ */
+void Parser::accept() 
+{
+    // 流式模式: 前面的四元式已经送出，这里送出剩余部分 (与非流式模式一样，未回填的跳转原样输出)
+    // 循环优化和临时变量复用需要完整的四元式序列，流式模式下不做
+    if (sink) 
+    {
+        streamPrefix();
+        for (const auto& q : emitted) sink(q);
+        streamed += emitted.size();
+        emitted.clear();
+        if (verbose) 
+        {
+            cout << "接受" << endl;
+            cout << "分析成功！" << endl;
+            cout << "已流式输出 " << streamed << " 条四元式" << endl;
+        }
+        return;
+    }
+
+    //接受，弹出符号栈栈顶最后的符号
+    Attribute res = move(symbolStack.top());
+
+    // 回填模式: 整个程序的 nextList 指向代码末尾，四元式取自全局序列
+    if (backpatch) 
+    {
+        backpatchList(res.nextList, emitted.size());
+        res.code = move(emitted);
+        emitted.clear();
+    }
+
+    // 可选: 循环优化 (在临时变量复用之前，复用会使临时变量被多次定值)
+    LoopOptStats ls = {0, 0, 0, 0};
+    if (loopOpt) 
+        ls = optimizeLoops(res.code);
+
+    // 可选: 基于活跃性分析把临时变量重新编号为最少的可复用槽位
+    TempRecycleStats ts = {0, 0, 0};
+    if (recycleTemps) 
+        ts = renumberTemps(res.code);
+    if (markNames() && !placeholderNames) 
+        rebaseQuads(res.code, 0, 0, 0);
+    result = move(res.code);
+
+    // 静默模式只保留结果，不打印也不写文件
+    if (!verbose) 
+        return;
+
+    cout << "接受" << endl;
+    cout << "分析成功！" << endl;
+    if (loopOpt) 
+    {
+        cout << "循环优化: " << ls.loops << " 个循环，外提 " << ls.hoisted << " 条，强度削弱 "
+             << ls.reduced << " 条，倒置 " << ls.inverted << " 个" << endl;
+    }
+    if (recycleTemps) 
+    {
+        cout << "临时变量复用: " << ts.originalTemps << " 个 -> " << ts.slots
+             << " 个，峰值活跃数 " << ts.peakLive << endl;
+    }
+    cout << "生成的四元式：" << endl;
+    
+    ofstream outFile("output.txt");
+    int line = 1;
+    for (const auto& q : result) 
+    {
+        string qStr = q.toString();
+        //按行打印到txt和屏幕上
+        cout << line << ": " << qStr << endl;
+        outFile << line++ << ": " << qStr << endl;
+    }
+    outFile.close();
+    cout << "四元式已保存到 output.txt" << endl;
+}
+
+/**
+ * @brief 送入一个向前看符号，执行直到它被移进、分析接受或出错
  * 
  * 算法流程:
- * 1. 初始化状态栈(压入0)和符号栈
- * 2. 循环读取输入符号 a
- * 3. 查 Action 表 Action[栈顶状态][a]
- *    - Shift(s): 状态压栈，符号压栈，读头前移
- *    - Reduce(r): 弹出 |RHS| 个状态和符号，查 Goto 表压入新状态，执行语义动作
+ * 1. 查 Action 表 Action[栈顶状态][a]
+ *    - Shift(s): 状态压栈，符号压栈，本次调用结束
+ *    - Reduce(r): 弹出 |RHS| 个状态和符号，查 Goto 表压入新状态，执行语义动作，继续查表
  *    - Accept(a): 分析成功，输出四元式
  *    - Error: 报错
+ * 2. 移进之后立即执行所有默认归约，它们不依赖下一个向前看符号
  */
-void Parser::parse(string input) 
+ParseStatus Parser::pushToken(const Token& look) 
 {
-    //初始化词法分析器，获得tokens
-    Lexer lexer(input);
-    vector<Token> tokens = lexer.tokenize();
-    
-    stack<int> stateStack;       // 状态栈
-    stack<Attribute> symbolStack;   // 符号栈 (存储语义属性)，
-                                    // 包含两个属性：place为变量名、标号名；code为四元式数组，用于输出
-    
-    stateStack.push(0); // 初始状态
-    int ip = 0; // tokens数组指针，用来逐行分析每个token种别码
-    
-    cout << "正在分析: " << input << endl;
-    cout << "步骤\t状态栈\t\t符号\t动作" << endl;
-    int step = 0;
+    string a = look.type;    //token的第一个属性id,while,{,},(,)
+    string val = look.value; //该token具体数值:数字，字母,while,{,},(,)
 
     while (true) 
     {
+        if (!drainDefaultReductions(val)) 
+            return syntaxError(val);
+
         int s = stateStack.top();//获取当前状态
-        string a = tokens[ip].type;  //token的第一个属性id,while,{,},(,)
-        string val = tokens[ip].value;//该token具体数值:数字，字母,while,{,},(,)
+        countState(s);
         
         // 打印分析过程
-        cout << ++step << "\t" << s << "\t\t" << val << "\t";
+        if (verbose) cout << ++step << "\t" << s << "\t\t" << val << "\t";
 
-        // 查表失败，报错
-        if (G.actionTable[s].find(a) == G.actionTable[s].end()) 
-        {
-            cout << "错误" << endl;
-            cout << "语法错误，在符号 " << val << " 处" << endl;
-            return;
-        }
-        
         //下一步动作--act
         // 根据当前状态栈栈顶s和符号栈栈顶a，查表决定下一步动作
-        Action act = G.actionTable[s][a];
+        stats.tableLookups++;
+        Action act = G.lookupAction(s, a);
+        if (profiling) 
+        {
+            profile.transitionHits[{s, a}]++;
+            profile.terminalHits[a]++;
+        }
+
+        // 查表失败 (或该条目被 %nonassoc 置为错误)，报错
+        if (act.type == 'e') 
+            return syntaxError(val);
         
         if (act.type == 's') 
         { // 移进动作
-            cout << "移进 " << act.val << endl;
+            if (verbose) cout << "移进 " << act.val << endl;
+            stats.shifts++;
             stateStack.push(act.val);//val 对于 Shift 是目标状态ID，对于 Reduce 是产生式ID
             Attribute attr;
             attr.place = val; // 终结符的 place 属性就是其词法值
             symbolStack.push(attr); //将当前符号的值压入符号栈中
-            ip++;//token数组++，读取下一个token
-
+            if (!drainDefaultReductions("-")) 
+                return syntaxError(val);
+            return PARSE_CONTINUE;
         } 
         else if (act.type == 'r') 
         { // 归约动作
-            int prodId = act.val;//val 对于 Shift 是目标状态ID，对于 Reduce 是产生式ID
-            Production prod = G.grammar[prodId];//获取规约的那条产生式prod
-            cout << "归约 " << prod.toString() << endl;
-            int len = prod.rhs.size();//获取规约的数量
-            
-            // 弹出右部符号对应的属性，准备进行语义计算
-            // 弹出对应产生式右部数量的状态栈和符号栈，符号栈的弹出用Attribute数组rhsAttrs记录下来
-            vector<Attribute> rhsAttrs(len);
-            for (int i = len - 1; i >= 0; --i) 
-            {
-                stateStack.pop();
-                rhsAttrs[i] = symbolStack.top();
-                symbolStack.pop();
-            }
-            
-            // 规约完后根据状态栈顶ID和产生式左部非终结符符号跳转（GOTO）到对应状态中
-            // 状态转移: Goto[当前栈顶][LHS]
-            int t = stateStack.top();
-            stateStack.push(G.gotoTable[t][prod.lhs]);//将跳转后的ID压入状态栈中
-            
-            Attribute lhsAttr; // 产生式左部的属性
-            
-            // --- 语义动作 (Semantic Actions) ---
-            // 根据不同的产生式，生成对应的四元式代码
-            
-            // 产生式: S -> while ( C ) { S }
-            // 逻辑:
-            // 1. 生成两个标号 startLabel, exitLabel
-            // 2. 代码结构:
-            //    startLabel:
-            //    (C 的代码)
-            //    if C is false goto exitLabel
-            //    (S 的代码)
-            //    goto startLabel
-            //    exitLabel:
-
-            // 填该Push进符号栈的符号lhsAttr也就是规约产生式左部符号
-            if (prod.rhs.size() == 7 && prod.rhs[0] == "while") 
-            {
-                Attribute C = rhsAttrs[2];
-                Attribute S1 = rhsAttrs[5];
-                
-                string startLabel = newLabel();
-                string exitLabel = newLabel();
-                
-                lhsAttr.code.push_back({"label", "-", "-", startLabel});//放置循环开始的标签L1，方便跳转
-                lhsAttr.code.insert(lhsAttr.code.end(), C.code.begin(), C.code.end());//插入条件C的代码
-                lhsAttr.code.push_back({"jfalse", C.place, "-", exitLabel});//如果C为假，跳转到出口L2
-                lhsAttr.code.insert(lhsAttr.code.end(), S1.code.begin(), S1.code.end());//C为真，执行S1代码
-                lhsAttr.code.push_back({"jump", "-", "-", startLabel});//生成无条件跳转指令，回到开头L1中
-                lhsAttr.code.push_back({"label", "-", "-", exitLabel});//循环退出的标签L2
-            }
-            // 产生式: S -> id = E
-            // 逻辑: 生成赋值四元式 (=, E.place, -, id.place)
-            else if (prod.rhs.size() == 3 && prod.rhs[1] == "=") 
-            {
-                Attribute id = rhsAttrs[0];
-                Attribute E = rhsAttrs[2];
-                
-                lhsAttr.code = E.code; // 继承 E 的代码（如果E = a+b这种复杂形式表达式时）
-                lhsAttr.code.push_back({"=", E.place, "-", id.place});
-            }
-            // 产生式: C -> E > E
-            // 逻辑: 生成比较四元式 (>, E1.place, E2.place, newTemp)
-            else if (prod.rhs.size() == 3 && prod.rhs[1] == ">") 
-            {
-                Attribute E1 = rhsAttrs[0];
-                Attribute E2 = rhsAttrs[2];
-                
-                lhsAttr.place = newTemp();//将计算结果临时存放在临时变量Tn中
-                //当E1和E2均是复杂表达式时
-                lhsAttr.code = E1.code;
-                lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
-                //添加四元式，结果存放在临时变量newTemp()中
-                lhsAttr.code.push_back({">", E1.place, E2.place, lhsAttr.place});
-            }
-            // 产生式: C -> E < E
-            else if (prod.rhs.size() == 3 && prod.rhs[1] == "<") 
-            {
-                Attribute E1 = rhsAttrs[0];
-                Attribute E2 = rhsAttrs[2];
-                
-                lhsAttr.place = newTemp();
-                lhsAttr.code = E1.code;
-                lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
-                lhsAttr.code.push_back({"<", E1.place, E2.place, lhsAttr.place});
-            }
-            // 产生式: C -> E == E
-            else if (prod.rhs.size() == 3 && prod.rhs[1] == "==") 
-            {
-                Attribute E1 = rhsAttrs[0];
-                Attribute E2 = rhsAttrs[2];
-                
-                lhsAttr.place = newTemp();
-                lhsAttr.code = E1.code;
-                lhsAttr.code.insert(lhsAttr.code.end(), E2.code.begin(), E2.code.end());
-                lhsAttr.code.push_back({"==", E1.place, E2.place, lhsAttr.place});
-            }
-            // 产生式: E -> id + E 或 E -> num + E
-            else if (prod.rhs.size() == 3 && prod.rhs[1] == "+") 
-            {
-                Attribute op1 = rhsAttrs[0]; // id 或 num
-                Attribute E2 = rhsAttrs[2];
-                
-                lhsAttr.place = newTemp();
-                lhsAttr.code = E2.code;
-                lhsAttr.code.push_back({"+", op1.place, E2.place, lhsAttr.place});
-            }
-            // 产生式: E -> id
-            // 逻辑: 传递属性
-            // 无需产生四元式
-            else if (prod.rhs.size() == 1 && prod.rhs[0] == "id") 
-            {
-                lhsAttr.place = rhsAttrs[0].place;//E的变量 = id的变量
-            }
-            // 产生式: E -> num
-            else if (prod.rhs.size() == 1 && prod.rhs[0] == "num") 
-            {
-                lhsAttr.place = rhsAttrs[0].place;
-            }
-            
-            symbolStack.push(lhsAttr);//将规约完的表达式存入符号栈中
-            
+            if (!reduce(act.val)) //val 对于 Shift 是目标状态ID，对于 Reduce 是产生式ID
+                return syntaxError(val);
         } 
         else if (act.type == 'a') 
         { // 接受动作
-            cout << "接受" << endl;
-            cout << "分析成功！" << endl;
-            //接受，弹出符号栈栈顶最后的符号
-            Attribute res = symbolStack.top();
-            cout << "生成的四元式：" << endl;
-            
-            ofstream outFile("output.txt");
-            int line = 1;
-            for (const auto& q : res.code) 
-            {
-                string qStr = q.toString();
-                //按行打印到txt和屏幕上
-                cout << line << ": " << qStr << endl;
-                outFile << line++ << ": " << qStr << endl;
-            }
-            outFile.close();
-            cout << "四元式已保存到 output.txt" << endl;
-            break;
+            accept();
+            return PARSE_ACCEPT;
+        }
+    }
+}
+
+/**
+ * @brief 核心分析函数
+ * 
+ * 词法分析器按需产生 Token，逐个送入 pushToken()，直到接受或出错
+ */
+bool Parser::parse(string_view input) 
+{
+    reset();
+    if (verbose) 
+    {
+        cout << "正在分析: " << input << endl;
+        cout << "步骤\t状态栈\t\t符号\t动作" << endl;
+    }
+
+    // Token 按需读取: 默认归约状态不需要向前看符号，词法分析可以落后一个 Token
+    Lexer lexer(input, &G.lexTable);
+    while (true) 
+    {
+        ParseStatus status = pushToken(lexer.next());
+        if (status == PARSE_ACCEPT) return true;
+        if (status == PARSE_ERROR) 
+        {
+            errorOffset = lexer.offset();
+            return false;
         }
     }
 }
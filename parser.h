@@ -3,6 +3,49 @@
 
 #include "common.h"
 #include "grammar.h"
+#include <stack>
+#include <functional>
+#include <string_view>
+
+/**
+ * @brief 一次语法分析的统计计数
+ */
+struct ParseStats 
+{
+    long long shifts;     // 移进次数
+    long long reductions; // 归约次数
+    long long tableLookups;       // Action/Goto 表查询次数
+    long long defaultReductions;  // 不查表、不读向前看符号的默认归约次数
+};
+
+/**
+ * @brief 剖析数据: 在训练语料上累计的状态与转移访问次数
+ */
+struct ParseProfile 
+{
+    vector<long long> stateHits;                      // [状态] -> 访问次数
+    map<pair<int, string>, long long> transitionHits; // (状态, 符号) -> 查 Action/Goto 表的次数
+    map<string, long long> terminalHits;              // 终结符 -> 作为向前看符号查表的次数
+};
+
+/**
+ * @brief 一次分析分配的临时变量与标号个数 (T1..Ttemps, L1..Llabels)
+ */
+struct QuadNumbering 
+{
+    int temps;
+    int labels;
+};
+
+/**
+ * @brief 推入一个 Token 后分析器的状态
+ */
+enum ParseStatus 
+{
+    PARSE_CONTINUE, // Token 已被移进，等待下一个 Token
+    PARSE_ACCEPT,   // 分析成功
+    PARSE_ERROR     // 语法错误
+};
 
 /**
  * @brief SLR(1) 语法分析器类
@@ -13,7 +56,16 @@ class Parser
     GrammarAnalyzer& G; ///< 引用文法分析器，获取分析表和产生式
     int tempCount;      ///< 临时变量计数器 (T1, T2...)
     int labelCount;     ///< 标号计数器 (L1, L2...)
+
+    stack<int> stateStack;        ///< 状态栈
+    stack<Attribute> symbolStack; ///< 符号栈 (存储语义属性)，place为变量名、标号名；code为四元式数组
+    int step;                     ///< 分析步骤计数，用于打印分析过程
     
+    /**
+     * @brief 生成的名字是否带保留前缀 kGeneratedMark
+     */
+    bool markNames() const;
+
     /**
      * @brief 生成新的临时变量
      * @return string 临时变量名，如 "T1"
@@ -25,24 +77,103 @@ class Parser
      * @return string 标号名，如 "L1"
      */
     string newLabel();
+
+    vector<Quad> emitted; ///< 回填模式下按生成顺序存放的全局四元式序列 (流式模式下只含尚未送出的部分，emitted[0] 的下标为 streamed)
+
+    /**
+     * @brief 回填模式: 追加一条四元式到全局序列
+     * @return 该四元式在整个序列中的下标
+     */
+    int emit(const Quad& q);
+
+    /**
+     * @brief 回填模式: 把 list 中各跳转四元式的目标填为 target
+     * @param target 目标四元式的下标 (输出时按从 1 开始的序号书写)
+     */
+    void backpatchList(const vector<int>& list, int target);
+
+    /**
+     * @brief 普通模式的语义动作: 条件计算出布尔临时变量，用 label/jfalse/jump 控制循环
+     */
+    void semanticAction(const Production& prod, vector<Attribute>& rhsAttrs, Attribute& lhsAttr);
+
+    /**
+     * @brief 回填模式的语义动作: 条件生成真/假出口链，跳转目标为四元式序号
+     */
+    void backpatchAction(const Production& prod, vector<Attribute>& rhsAttrs, Attribute& lhsAttr);
+
+    /**
+     * @brief 流式模式: 归约后属性栈只剩一个符号时，把其中已经确定的四元式送到 sink 并丢弃
+     */
+    void streamPrefix();
+
+    void countState(int s);
+    bool reduce(int prodId);
+    bool drainDefaultReductions(const string& val);
+    ParseStatus syntaxError(const string& val);
+    void accept();
     
 public:
+    bool recycleTemps;    ///< 是否在接受时做活跃性分析并复用临时变量
+    bool backpatch;       ///< 是否使用回填方式生成条件与循环代码
+    bool loopOpt;         ///< 是否在接受时做循环优化 (不变代码外提、强度削弱、循环倒置)
+    bool verbose;         ///< 是否打印分析过程并把四元式写入 output.txt
+    bool profiling;       ///< 是否记录剖析数据 (跨多次 parse 累计)
+    bool placeholderNames; ///< 生成的临时变量与标号名加上保留前缀 kGeneratedMark，之后由 rebaseQuads() 重新编号
+    ParseProfile profile; ///< 剖析数据
+    vector<Quad> result;  ///< 最近一次分析成功生成的四元式序列 (流式模式下为空)
+    function<void(const Quad&)> sink; ///< 非空时为流式模式: 四元式一经确定就按顺序送出，不再保留 (见 streamPrefix())
+    int streamed;         ///< 流式模式下最近一次分析已送出的四元式条数
+    function<void()> onTopLevel; ///< 流式模式下归约后属性栈只剩一个符号时调用 (sink 已收到其中确定的四元式)
+    ParseStats stats;     ///< 最近一次分析的统计计数
+    string errorSymbol;   ///< 最近一次分析出错处的符号 (静默模式下不打印错误，由调用者报告)
+    size_t errorOffset;   ///< 最近一次 parse() 出错时，出错符号之后在 input 中的字节位置
+
     /**
      * @brief 构造函数
      * @param grammar 已经初始化好的文法分析器引用
      */
     Parser(GrammarAnalyzer& grammar);
 
+    /**
+     * @brief 最近一次分析实际分配的临时变量与标号个数
+     */
+    QuadNumbering numbering() const;
+
+    /**
+     * @brief 当前的栈顶状态
+     */
+    int topState() const;
+
+    /**
+     * @brief 流式模式下在顶层检查点处 (onTopLevel 中，四元式已全部送出) 把临时变量、标号和四元式序号重新从 1 开始
+     * 之后的代码与从该处单独开始分析得到的代码相同，由调用者按段重新编号拼接
+     */
+    void restartNumbering();
+
+    /**
+     * @brief 重置分析器: 清空栈并压入初始状态，计数器归零
+     */
+    void reset();
+
+    /**
+     * @brief 推入一个 Token (推式接口)
+     * 分析栈、属性栈在多次调用之间保持，输入结束时推入 {"#", "#"}
+     * @return 该 Token 被移进后返回 PARSE_CONTINUE，接受或出错时返回对应状态
+     */
+    ParseStatus pushToken(const Token& look);
+
     /**
      * @brief 执行语法分析
-     * @param input 输入的源代码字符串
+     * @param input 输入的源代码 (不复制，可以是更大的源文件中的一段)
      * 
      * 过程:
-     * 1. 调用 Lexer 将输入转换为 Token 序列
+     * 1. 调用 Lexer 按需读取 Token (默认归约状态不读取向前看符号)
      * 2. 使用状态栈和符号栈进行移进-归约分析
      * 3. 在归约时执行语义动作，生成四元式
+     * @return 分析成功返回 true，四元式保存在 result 中
      */
-    void parse(string input);
+    bool parse(string_view input);
 };
 
 #endif
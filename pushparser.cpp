@@ -0,0 +1,53 @@
+#include "pushparser.h"
+
+PushParser::PushParser(GrammarAnalyzer& G) : lexTable(&G.lexTable), lexer(&G.lexTable), status(PARSE_CONTINUE), parser(G) 
+{
+    parser.verbose = false;
+    parser.reset();
+}
+
+void PushParser::reset() 
+{
+    lexer = Lexer(lexTable);
+    status = PARSE_CONTINUE;
+    parser.reset();
+}
+
+ParseStatus PushParser::pump() 
+{
+    Token tok;
+    while (status == PARSE_CONTINUE && lexer.tryNext(tok)) 
+        status = parser.pushToken(tok);
+    return status;
+}
+
+ParseStatus PushParser::feed(const string& bytes) 
+{
+    if (status != PARSE_CONTINUE) return status;
+    lexer.feed(bytes);
+    return pump();
+}
+
+ParseStatus PushParser::feed(const vector<Token>& tokens) 
+{
+    for (const auto& tok : tokens) 
+    {
+        if (status != PARSE_CONTINUE) break;
+        status = parser.pushToken(tok);
+    }
+    return status;
+}
+
+ParseStatus PushParser::finish() 
+{
+    if (status != PARSE_CONTINUE) return status;
+    lexer.finish();
+    pump();
+    // 词法分析器在输入结束后总会产生结束符，分析器对结束符只会接受或报错
+    return status;
+}
+
+ParseStatus PushParser::state() const 
+{
+    return status;
+}
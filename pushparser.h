@@ -0,0 +1,66 @@
+#ifndef PUSHPARSER_H
+#define PUSHPARSER_H
+
+#include "common.h"
+#include "grammar.h"
+#include "parser.h"
+#include "lexer.h"
+
+/**
+ * @brief 推式 (可恢复) 语法分析器
+ * 输入可以分多次以字节块或 Token 的形式送入，分析栈、属性栈和词法分析器状态在调用之间保持，
+ * 适合数据通过管道陆续到达的场景: 每块数据到达后立即分析，不缓存整个输入，也不需要阻塞等待的分析线程
+ *
+ * 用法:
+ *   PushParser pp(G);
+ *   pp.feed("while ( a > ");
+ *   pp.feed("b ) { x = y }");
+ *   if (pp.finish() == PARSE_ACCEPT) { 使用 pp.parser.result }
+ */
+class PushParser 
+{
+    const LexTable* lexTable; // 文法生成的词法分析表
+    Lexer lexer;        // 流式词法分析器
+    ParseStatus status; // 当前状态，接受或出错后不再接收输入
+
+    /**
+     * @brief 把词法分析器中已经完整的 Token 依次送入分析器
+     */
+    ParseStatus pump();
+
+public:
+    Parser parser; ///< 内部的分析器，可设置其选项，分析成功后结果在 parser.result 中
+
+    /**
+     * @param G 已构建好分析表的文法分析器
+     */
+    PushParser(GrammarAnalyzer& G);
+
+    /**
+     * @brief 丢弃当前进度，重新开始一次分析 (保留 parser 的选项)
+     */
+    void reset();
+
+    /**
+     * @brief 送入一块源代码字节，块边界可以落在 Token 中间
+     */
+    ParseStatus feed(const string& bytes);
+
+    /**
+     * @brief 送入一批已经识别好的 Token (不含结束符)
+     */
+    ParseStatus feed(const vector<Token>& tokens);
+
+    /**
+     * @brief 输入结束，分析剩余的 Token 并送入结束符
+     * @return PARSE_ACCEPT 或 PARSE_ERROR
+     */
+    ParseStatus finish();
+
+    /**
+     * @brief 当前状态
+     */
+    ParseStatus state() const;
+};
+
+#endif
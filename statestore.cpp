@@ -0,0 +1,135 @@
+#include "statestore.h"
+#include <algorithm>
+#include <cassert>
+
+StateStore::StateStore() : itemOffset(1, 0), slots(16, -1), count(0), released(false) {}
+
+int StateStore::size() const
+{
+    return count;
+}
+
+size_t StateStore::itemCount() const
+{
+    return items.size();
+}
+
+size_t StateStore::transitionCount() const
+{
+    return transitions.size();
+}
+
+StateView StateStore::operator[](int s) const
+{
+    assert(!released && s >= 0 && s < count);
+    const Item* base = items.data();
+    const Transition* trans = transitions.data();
+    return {s, {base + itemOffset[s], base + itemOffset[s + 1]},
+            {trans + transBegin[s], trans + transBegin[s] + transCount[s]}};
+}
+
+// FNV-1a，与编译缓存使用的散列相同
+size_t StateStore::hashKernel(const Item* first, const Item* last)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for (const Item* it = first; it != last; ++it)
+    {
+        h = (h ^ (unsigned)it->prodIndex) * 1099511628211ULL;
+        h = (h ^ (unsigned)it->dotPos) * 1099511628211ULL;
+    }
+    return h;
+}
+
+int StateStore::find(const vector<Item>& kernel) const
+{
+    size_t h = hashKernel(kernel.data(), kernel.data() + kernel.size());
+    size_t mask = slots.size() - 1;
+    for (size_t i = h & mask; slots[i] >= 0; i = (i + 1) & mask)
+    {
+        int s = slots[i];
+        if (kernelHash[s] == h && itemOffset[s + 1] - itemOffset[s] == (int)kernel.size()
+            && equal(kernel.begin(), kernel.end(), items.begin() + itemOffset[s]))
+            return s;
+    }
+    return -1;
+}
+
+int StateStore::add(const vector<Item>& kernel)
+{
+    int s = count++;
+    items.insert(items.end(), kernel.begin(), kernel.end());
+    itemOffset.push_back(items.size());
+    transBegin.push_back(transitions.size());
+    transCount.push_back(0);
+    kernelHash.push_back(hashKernel(kernel.data(), kernel.data() + kernel.size()));
+
+    // 装载因子超过 1/2 时扩容
+    if ((size_t)count * 2 > slots.size()) rehash(slots.size() * 2);
+    else
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = kernelHash[s] & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+    return s;
+}
+
+void StateStore::rehash(size_t slotCount)
+{
+    slots.assign(slotCount, -1);
+    size_t mask = slotCount - 1;
+    for (int s = 0; s < count; ++s)
+    {
+        size_t i = kernelHash[s] & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = s;
+    }
+}
+
+void StateStore::setTransitions(int s, const vector<Transition>& trans)
+{
+    transBegin[s] = transitions.size();
+    transCount[s] = trans.size();
+    transitions.insert(transitions.end(), trans.begin(), trans.end());
+}
+
+void StateStore::renumber(const vector<int>& order, const vector<int>& newId)
+{
+    StateStore result;
+    for (int old : order)
+    {
+        vector<Item> kernel(items.begin() + itemOffset[old], items.begin() + itemOffset[old + 1]);
+        result.add(kernel);
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        vector<Transition> trans(transitions.begin() + transBegin[order[i]],
+                                 transitions.begin() + transBegin[order[i]] + transCount[order[i]]);
+        for (auto& t : trans) t.target = newId[t.target];
+        result.setTransitions(i, trans);
+    }
+    *this = move(result);
+}
+
+void StateStore::release()
+{
+    int n = count;
+    *this = StateStore();
+    count = n;
+    released = true;
+}
+
+void StateStore::reset(int n)
+{
+    release();
+    count = n;
+}
+
+size_t StateStore::memoryBytes() const
+{
+    return items.capacity() * sizeof(Item) + itemOffset.capacity() * sizeof(int)
+         + transitions.capacity() * sizeof(Transition) + transBegin.capacity() * sizeof(int)
+         + transCount.capacity() * sizeof(int) + kernelHash.capacity() * sizeof(size_t)
+         + slots.capacity() * sizeof(int);
+}
@@ -0,0 +1,137 @@
+#ifndef STATESTORE_H
+#define STATESTORE_H
+
+#include "common.h"
+
+/**
+ * @brief 状态转移: 符号编号 -> 目标状态
+ */
+struct Transition
+{
+    int symbol; // 符号编号 (GrammarAnalyzer::symbols 的下标，按符号名的字典序编号)
+    int target; // 目标状态
+
+    bool operator==(const Transition& other) const
+    {
+        return symbol == other.symbol && target == other.target;
+    }
+};
+
+/**
+ * @brief 连续数组中的一段 (只读，不拥有数据)
+ */
+template <typename T>
+struct ConstRange
+{
+    const T* first;
+    const T* last;
+
+    const T* begin() const { return first; }
+    const T* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const T& operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * @brief 一个 LR(0) 状态的只读视图
+ * 只保存核心项目 (圆点不在最左边的项目，以及初始状态的 S' -> . S)，
+ * 完整的项目集由 GrammarAnalyzer 按需求闭包得到；核心项目相同的两个项目集闭包也相同
+ */
+struct StateView
+{
+    int id;                              // 状态编号
+    ConstRange<Item> kernel;             // 核心项目，按 (产生式, 圆点) 排序
+    ConstRange<Transition> transitions;  // 转移，按符号编号排序
+};
+
+/**
+ * @brief 列式的状态存储
+ *
+ * 代替每个状态各持有一棵项目红黑树和一棵转移红黑树的做法:
+ * - 所有状态的核心项目按状态编号依次存放在一个数组中，itemOffset 给出每个状态的起点
+ * - 所有转移存放在一个数组中，同一状态的转移连续且按符号编号排序；
+ *   惰性模式下各状态的转移按计算顺序追加，因此用 transBegin/transCount 而不是前缀和定位
+ * - 按核心项目查找已有状态使用开放定址的散列表 (线性探测)，不再逐个比较全部状态
+ * 每个项目 8 字节、每条转移 8 字节，没有树节点的指针和颜色开销，构造和查表时访问的内存也是连续的
+ */
+class StateStore
+{
+public:
+    StateStore();
+
+    /**
+     * @brief 状态个数 (release() 之后仍然保留)
+     */
+    int size() const;
+
+    /**
+     * @brief 核心项目总数
+     */
+    size_t itemCount() const;
+
+    /**
+     * @brief 转移总数
+     */
+    size_t transitionCount() const;
+
+    /**
+     * @brief 取状态 s 的只读视图 (视图在加入新状态或设置转移后可能失效)
+     * release() 或 reset() 之后不再有项目和转移，不能调用
+     */
+    StateView operator[](int s) const;
+
+    /**
+     * @brief 查找核心项目为 kernel 的状态
+     * @param kernel 已排序的核心项目
+     * @return 状态编号，不存在时返回 -1
+     */
+    int find(const vector<Item>& kernel) const;
+
+    /**
+     * @brief 加入一个新状态 (调用者保证不存在相同的核心项目)
+     * @return 新状态的编号
+     */
+    int add(const vector<Item>& kernel);
+
+    /**
+     * @brief 设置状态 s 的转移 (按符号编号排序)，每个状态只设置一次
+     */
+    void setTransitions(int s, const vector<Transition>& trans);
+
+    /**
+     * @brief 按新编号重排状态: 新状态 i 为旧状态 order[i]，转移目标用 newId 改写
+     */
+    void renumber(const vector<int>& order, const vector<int>& newId);
+
+    /**
+     * @brief 释放全部数组，只保留状态个数 (分析表冻结后调用)
+     */
+    void release();
+
+    /**
+     * @brief 清空后设置状态个数，没有项目和转移 (用于装入现成的分析表)
+     */
+    void reset(int count);
+
+    /**
+     * @brief 各数组占用的字节数 (按容量计)
+     */
+    size_t memoryBytes() const;
+
+private:
+    vector<Item> items;            // 所有状态的核心项目
+    vector<int> itemOffset;        // 状态 s 的核心项目为 items[itemOffset[s], itemOffset[s + 1])
+    vector<Transition> transitions;
+    vector<int> transBegin;        // [状态] -> 转移在 transitions 中的起点
+    vector<int> transCount;        // [状态] -> 转移条数 (尚未计算时为 0)
+    vector<size_t> kernelHash;     // [状态] -> 核心项目的散列值
+    vector<int> slots;             // 散列表: 状态编号，-1 为空位，大小为 2 的幂
+    int count;                     // 状态个数
+    bool released;                 // 是否已经 release()/reset()，只剩状态个数
+
+    static size_t hashKernel(const Item* first, const Item* last);
+    void rehash(size_t slotCount);
+};
+
+#endif